@@ -25,6 +25,7 @@
 
 
 #include <arrow/api.h>
+#include <arrow/c/bridge.h>
 #include <arrow/python/pyarrow.h>
 #include "../src/caster.hpp"
 
@@ -45,6 +46,54 @@ PYBIND11_MODULE(gribtoarrow, m)
     py::register_exception<CodesGetDoubleValuesAsArrayException>(m, "CodesGetDoubleValuesAsArrayException");
 
     py::module::import("pyarrow");
+    py::enum_<ColumnEncoding>(m, "ColumnEncoding", R"EOL(
+            How the columns which have the same value for every point of a message are stored.
+            Dense repeats the value, RunEnd stores it once and Dictionary stores it once with a one byte index per point.
+        )EOL")
+        .value("Dense", ColumnEncoding::Dense)
+        .value("RunEnd", ColumnEncoding::RunEnd)
+        .value("Dictionary", ColumnEncoding::Dictionary);
+    py::enum_<NearestMethod>(m, "NearestMethod", R"EOL(
+            How the nearest grid point to each location is found.
+            Eccodes uses grib_nearest_find_multiple, KdTree searches a kd-tree built once from the coordinates of the grid.
+            Projection projects each location onto regular, rotated and lambert grids (other grids use eccodes).
+        )EOL")
+        .value("Eccodes", NearestMethod::Eccodes)
+        .value("KdTree", NearestMethod::KdTree)
+        .value("Projection", NearestMethod::Projection);
+    py::enum_<InterpolationMethod>(m, "InterpolationMethod", R"EOL(
+            How the value at each location is calculated.
+            Nearest uses the nearest grid point, Bilinear the 4 surrounding points and InverseDistance the k nearest points.
+        )EOL")
+        .value("Nearest", InterpolationMethod::Nearest)
+        .value("Bilinear", InterpolationMethod::Bilinear)
+        .value("InverseDistance", InterpolationMethod::InverseDistance);
+    py::enum_<ValueExtraction>(m, "ValueExtraction", R"EOL(
+            How the values at the locations are read from a message.
+            Elements reads each value with codes_get_double_elements, FullDecode decodes the whole field once and gathers the
+            locations from it and Auto chooses using the packing type of the message and the number of values needed.
+        )EOL")
+        .value("Auto", ValueExtraction::Auto)
+        .value("Elements", ValueExtraction::Elements)
+        .value("FullDecode", ValueExtraction::FullDecode);
+    py::class_<ExtractionStats>(m, "ExtractionStats", R"EOL(
+            Which path was used to read the values at the locations of a message and how long it took.
+        )EOL")
+        .def_readonly("method", &ExtractionStats::method)
+        .def_readonly("packingType", &ExtractionStats::packingType)
+        .def_readonly("requestedValues", &ExtractionStats::requestedValues)
+        .def_readonly("numberOfPoints", &ExtractionStats::numberOfPoints)
+        .def_readonly("milliseconds", &ExtractionStats::milliseconds);
+    py::class_<CacheStats>(m, "CacheStats", R"EOL(
+            The counters of one of the grid caches of a reader.
+        )EOL")
+        .def_readonly("hits", &CacheStats::hits)
+        .def_readonly("misses", &CacheStats::misses)
+        .def_readonly("evictions", &CacheStats::evictions)
+        .def_readonly("entries", &CacheStats::entries)
+        .def_readonly("bytes", &CacheStats::bytes)
+        .def_readonly("capacityBytes", &CacheStats::capacityBytes);
+
     py::class_<GribReader>(m, "GribReader")
         .def(py::init<string>(), pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
             Creates a new Grib reader. 
@@ -125,6 +174,254 @@ PYBIND11_MODULE(gribtoarrow, m)
         .def("withRepeatableIterator", &GribReader::withRepeatableIterator, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
             Enables the message to be iterated multiple times.                 
         )EOL") 
+        .def("withThreads", &GribReader::withThreads, 
+                py::arg("numberOfThreads"), 
+                py::arg("maxBufferedMessages") = 0,
+                pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Decodes messages on a pool of threads. 
+
+            Parameters
+            ----------
+            numberOfThreads (int): The number of worker threads, 0 uses every core
+            maxBufferedMessages (int): The maximum number of decoded messages waiting to be consumed.
+            Defaults to twice the number of threads.
+
+            Each worker decodes a message and builds its arrow table (getDataWithLocations if locations 
+            were passed to the reader otherwise getData). Messages are still returned in message id order.               
+        )EOL") 
+        .def("withMemoryMappedInput", &GribReader::withMemoryMappedInput, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Memory maps the grib file instead of reading it via a file handle. 
+
+            Parameters
+            ----------
+            enableMemoryMap (bool): If True the messages are decoded directly from the mapped file without 
+            copying them into a separate buffer.              
+        )EOL") 
+        .def("withFilter", py::overload_cast<std::string, std::vector<long>>(&GribReader::withFilter), pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Only returns messages where the numeric key is one of the values given.
+            The key is read from the headers of the message so messages which don't match are skipped before 
+            their data is decoded. Multiple filters can be added and all of them must match.
+
+            Parameters
+            ----------
+            key (string): The name of the key e.g. paramId, number, level
+            values (list[int]): The values to keep e.g. [167, 228164]               
+        )EOL") 
+        .def("withFilter", py::overload_cast<std::string, std::vector<std::string>>(&GribReader::withFilter), pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Only returns messages where the string key is one of the values given.
+            The key is read from the headers of the message so messages which don't match are skipped before 
+            their data is decoded. Multiple filters can be added and all of them must match.
+
+            Parameters
+            ----------
+            key (string): The name of the key e.g. shortName, typeOfLevel
+            values (list[str]): The values to keep e.g. ["2t", "tcc"]               
+        )EOL") 
+        .def("withRangeFilter", &GribReader::withRangeFilter, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Only returns messages where the key is between minimum and maximum (inclusive).
+            The key is read from the headers of the message so messages which don't match are skipped before 
+            their data is decoded. Multiple filters can be added and all of them must match.
+
+            Parameters
+            ----------
+            key (string): The name of the key e.g. step
+            minimum (float): The smallest value to keep
+            maximum (float): The largest value to keep               
+        )EOL") 
+        .def("withIndex", py::overload_cast<>(&GribReader::withIndex), pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Loads the index of message offsets saved next to the grib file (the grib path with the suffix .arrowidx).
+            If the index doesn't exist or the grib file has changed since it was created the index is built and saved.
+
+            The index allows individual messages to be read with reader[i] or reader[start:stop] without 
+            iterating over the file.              
+        )EOL") 
+        .def("withIndex", py::overload_cast<std::string>(&GribReader::withIndex), pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Loads the index of message offsets from the path specified.
+            If the index doesn't exist or the grib file has changed since it was created the index is built and saved.
+
+            Parameters
+            ----------
+            indexPath (string): Path of the index file              
+        )EOL") 
+        .def("withValueType", &GribReader::withValueType, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Sets the type of the values, coordinates and distances returned by getData and getDataWithLocations.
+            Grib values are usually packed at 12 to 16 bits so float32 halves the memory used without losing precision.
+
+            Parameters
+            ----------
+            valueType (pyarrow.DataType): pyarrow.float64() (the default) or pyarrow.float32()              
+        )EOL") 
+        .def("withColumns", &GribReader::withColumns, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Sets the columns returned by getData / getDataWithLocations when they are called without any columns.
+            These are also the columns of toRecordBatchReader and the columns built when messages are decoded with withThreads.
+
+            Parameters
+            ----------
+            columns (list[str]): The names of the columns to return              
+        )EOL") 
+        .def("withConstantColumnEncoding", &GribReader::withConstantColumnEncoding, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Sets how parameterId, modelNo, forecast_date and datetime are stored. These have the same value for every point
+            in a message so with ColumnEncoding.RunEnd or ColumnEncoding.Dictionary they don't grow with the size of the grid.
+
+            Parameters
+            ----------
+            encoding (ColumnEncoding): ColumnEncoding.Dense (the default), ColumnEncoding.RunEnd or ColumnEncoding.Dictionary              
+        )EOL") 
+        .def("withNearestMethod", &GribReader::withNearestMethod, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Sets how the nearest grid point to each location passed to withLocations is found.
+            NearestMethod.KdTree builds a kd-tree from the coordinates of the grid once per grid and searches it on
+            multiple threads, which is much faster than eccodes when there are many locations.
+            NearestMethod.Projection projects each location into the grid using the projection of the message
+            (regular, rotated and lambert conformal grids) and picks the nearest corner of the grid cell around it.
+
+            Parameters
+            ----------
+            method (NearestMethod): NearestMethod.Eccodes (the default), NearestMethod.KdTree or NearestMethod.Projection              
+        )EOL") 
+        .def("withInterpolation", &GribReader::withInterpolation, 
+                py::arg("method"), 
+                py::arg("neighbours") = 4,
+                pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Sets how the value at each location passed to withLocations is calculated.
+            The points and weights used for each location are calculated once per grid, every message then only
+            decodes the values of those points. The distance, nearestlatitude and nearestlongitude columns still
+            describe the nearest grid point.
+
+            Parameters
+            ----------
+            method (InterpolationMethod): InterpolationMethod.Nearest (the default), InterpolationMethod.Bilinear
+            or InterpolationMethod.InverseDistance
+            neighbours (int): The number of points used by InterpolationMethod.InverseDistance, defaults to 4              
+        )EOL") 
+        .def("withValueExtraction", &GribReader::withValueExtraction, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Sets how the values at the locations are read from each message. By default (ValueExtraction.Auto)
+            codes_get_double_elements is only used for simple packing when a small fraction of the grid is needed,
+            otherwise the whole field is decoded once and the values gathered from it.
+            message.getExtractionStats() shows which path was used.
+
+            Parameters
+            ----------
+            extraction (ValueExtraction): ValueExtraction.Auto, ValueExtraction.Elements or ValueExtraction.FullDecode              
+        )EOL") 
+        .def("withLocationStore", &GribReader::withLocationStore, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Saves the locations matched to each grid (the nearest points, distances and interpolation weights) in a directory
+            so later readers, including ones in other processes, don't have to search the grid again.
+            The files are arrow IPC files named after a hash of the grid definition, the locations and the matching settings
+            and are memory mapped when they are loaded.
+
+            Parameters
+            ----------
+            directory (string): The directory to save the files in, it is created if it doesn't exist              
+        )EOL") 
+        .def("withCacheLimit", &GribReader::withCacheLimit, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Sets the memory the nearest points of the locations and the coordinates of each grid can use.
+            Each cache keeps the grids it has seen until it uses more than capacityBytes, then the least recently used
+            grids are removed. Defaults to 1GB per cache.
+
+            Parameters
+            ----------
+            capacityBytes (int): The maximum number of bytes used by each cache              
+        )EOL") 
+        .def("getCacheStats", &GribReader::getCacheStats, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Returns a dict with the CacheStats (hits, misses, evictions, entries, bytes and capacityBytes) of the 
+            "locations" and "coordinates" caches              
+        )EOL") 
+        .def("getIndex", &GribReader::getIndex, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Returns a pyarrow table with a row per message containing the message id, its offset and length in the
+            file and the keys paramId, shortName, typeOfLevel, level, step, number, date, time and editionNumber              
+        )EOL") 
+        .def("inventory", &GribReader::inventory, py::arg("keys") = GribReader::defaultInventoryKeys(), pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Returns a pyarrow table with a row per message and a column per key, similar to grib_ls.
+            Only the headers of the messages are decoded and the messages are scanned on multiple threads.
+
+            Parameters
+            ----------
+            keys (list[str]): The keys to read, defaults to shortName, paramId, step, level, number, date, gridType,
+            offset and length. messageId, offset and length give the position of the message in the file.
+            A message which doesn't have a key has a null value.
+        )EOL") 
+        .def("__len__", &GribReader::getNumberOfMessages, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            The number of messages in the file              
+        )EOL") 
+        .def("__getitem__", [](GribReader &s, long messageId) {
+                if (messageId < 0) {
+                    messageId += s.getNumberOfMessages();
+                }
+                py::gil_scoped_release release;
+                return s.getMessage(messageId);
+            }, 
+            py::return_value_policy::take_ownership,
+            py::keep_alive<0, 1>(), R"EOL(
+            Reads the message with the given message id without iterating over the messages before it              
+        )EOL") 
+        .def("__getitem__", [](py::object self, py::slice slice) {
+                auto& s = self.cast<GribReader&>();
+                size_t start, stop, step, length;
+                if (!slice.compute(s.getNumberOfMessages(), &start, &stop, &step, &length)) {
+                    throw py::error_already_set();
+                }
+                py::list messages;
+                for (size_t i = 0; i < length; i++) {
+                    GribMessage* message;
+                    {
+                        py::gil_scoped_release release;
+                        message = s.getMessage((long)(start + i * step));
+                    }
+                    auto pyMessage = py::cast(message, py::return_value_policy::take_ownership);
+                    //The messages reference the reader so it must live as long as they do
+                    py::detail::keep_alive_impl(pyMessage, self);
+                    messages.append(pyMessage);
+                }
+                return messages;
+            }, R"EOL(
+            Reads the messages in the slice without iterating over the rest of the file              
+        )EOL") 
+        .def("__arrow_c_stream__", [](GribReader &s, py::object requested_schema) {
+                auto stream = new ArrowArrayStream;
+                arrow::Status status;
+                {
+                    py::gil_scoped_release release;
+                    status = arrow::ExportRecordBatchReader(s.toRecordBatchReader(), stream);
+                }
+                if (!status.ok()) {
+                    delete stream;
+                    throw ArrowGenericException("Unable to export record batch reader " + status.message());
+                }
+                return py::capsule(stream, "arrow_array_stream", [](PyObject* capsule) {
+                    auto stream = (ArrowArrayStream*)PyCapsule_GetPointer(capsule, "arrow_array_stream");
+                    //The stream is released by whoever imports it, this only covers a capsule which was never used
+                    if (stream->release != nullptr) {
+                        stream->release(stream);
+                    }
+                    delete stream;
+                });
+            }, 
+            py::arg("requested_schema") = py::none(), R"EOL(
+            Exports every message in the file as an arrow C stream (the arrow PyCapsule interface) so the 
+            reader can be passed directly to libraries such as polars, duckdb and pyarrow. 
+            The requested_schema is ignored.              
+        )EOL") 
+        .def("toRecordBatchReader", [](py::object self) {
+                auto capsule = self.attr("__arrow_c_stream__")();
+                return py::module::import("pyarrow").attr("RecordBatchReader").attr("_import_from_c_capsule")(capsule);
+            }, R"EOL(
+            Returns a pyarrow.RecordBatchReader which streams every message in the file with one record batch per message.
+            Only one message is decoded at a time so memory stays bounded however large the file is.
+
+            If locations were passed to the reader each batch contains the results of getDataWithLocations 
+            otherwise each batch contains the results of getData along with the parameterId, modelNo,
+            forecast_date and datetime of the message.              
+        )EOL") 
+        .def("toStationTimeSeries", &GribReader::toStationTimeSeries, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Reads every message into a pyarrow.Table with a row per location and a column per parameter and valid time.
+            The columns of the locations come first followed by a column named parameterId_validtime 
+            (e.g. 167_2024-01-01T06:00:00) for each parameter and valid time, the field metadata holds the parameterId 
+            and datetime. Locations a message doesn't cover are null.
+
+            The values of each message are written straight into the columns so the results don't need to be 
+            concatenated and pivoted. Use withFilter to select a single level and ensemble member, a GribException
+            is raised if two messages have the same parameter and valid time.
+        )EOL") 
         .def(
             "__iter__",
             [](GribReader &s) { return py::make_iterator(s.begin(), s.end()); },
@@ -199,13 +496,34 @@ PYBIND11_MODULE(gribtoarrow, m)
         .def("getGridDefinitionTemplateNumber", &GribMessage::getGridDefinitionTemplateNumber, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
             Gets the grid defintion template number               
         )EOL") 
-        .def("getData", &GribMessage::getData, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+        .def("getData", &GribMessage::getData, py::arg("columns") = std::vector<std::string>(), pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
             Gets the Data from the message
 
             Return 3 fields the value and the latitude and longitude or the value               
+
+            Parameters
+            ----------
+            columns (list[str]): Optional names of the columns to return, any of Latitudes, Longitudes, Values, parameterId,
+            modelNo, forecast_date and datetime. Columns which aren't requested are never computed.
         )EOL") 
-        .def("getDataWithLocations", &GribMessage::getDataWithLocations, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+        .def("getDataWithLocations", &GribMessage::getDataWithLocations, py::arg("columns") = std::vector<std::string>(), pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
             Return the values constrained by the locations specified in table to restrict by when passed in the reader              
+
+            Parameters
+            ----------
+            columns (list[str]): Optional names of the columns to return e.g. ["surrogate_key", "datetime", "value"].
+            Columns which aren't requested are never computed.
+        )EOL") 
+        .def("getDataInArea", &GribMessage::getDataInArea, py::arg("north"), py::arg("west"), py::arg("south"), py::arg("east"), pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Return the Latitudes, Longitudes and Values of the points inside an area. Only the values of those points
+            are read, regular and rotated grids work out the rows and columns of the area from the grid definition.
+
+            Parameters
+            ----------
+            north (float): The northern latitude of the area
+            west (float): The western longitude of the area
+            south (float): The southern latitude of the area
+            east (float): The eastern longitude of the area, less than west for areas crossing the antimeridian
         )EOL") 
         .def("iScansNegatively", &GribMessage::iScansNegatively, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
             Return if the i(s) scan negatively in the grid              
@@ -238,6 +556,18 @@ PYBIND11_MODULE(gribtoarrow, m)
                 ,pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
             Get the key passed to it or if the key is missing returns None             
         )EOL") 
+        .def("getKeys", &GribMessage::getKeys, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Reads several keys at once and returns them as a pyarrow RecordBatch with a single row.
+            Each key is read using its native type (int64, float64 or string), a missing key is null.
+
+            Parameters
+            ----------
+            keys (list[str]): The names of the keys to read              
+        )EOL") 
+        .def("getExtractionStats", &GribMessage::getExtractionStats, pybind11::call_guard<pybind11::gil_scoped_release>(), R"EOL(
+            Returns the ExtractionStats describing how the values at the locations were read (the method, packingType,
+            requestedValues, numberOfPoints and milliseconds) or None if getDataWithLocations hasn't been called              
+        )EOL") 
         .doc() = R"EOL(
             This class provides the ability to access attributes such as the parameterId  
 
@@ -1,6 +1,8 @@
 #include <arrow/api.h>
 #include <arrow/result.h>
 #include <arrow/compute/api_scalar.h>
+#include <arrow/compute/cast.h>
+#include <arrow/util/bitmap_generate.h>
 #include <arrow/dataset/file_ipc.h>
 #include <arrow/compute/expression.h>
 #include <cstdint>
@@ -11,6 +13,8 @@
 #include <iostream>
 #include <vector>
 #include "arrowutils.hpp"
+#include "exceptions/memoryallocationexception.hpp"
+#include "exceptions/arrowgenericexception.hpp"
 
 namespace cp = arrow::compute;
 
@@ -69,107 +73,145 @@ arrow::Result<std::vector<data_row>> ColumnarTableToVector(
 }
 
 
-arrow::Result<std::shared_ptr<arrow::Array>> doubleFieldToArrow(long numberOfPoints, 
-            double *fieldValues, 
-            bool replaceMissingWithNull) {
+std::shared_ptr<arrow::Buffer> allocateBuffer(long numberOfPoints, size_t valueSize) {
 
-    arrow::DoubleBuilder valuesBuilder;
-
-    if (replaceMissingWithNull) {
+    auto numBytes = (int64_t)(numberOfPoints * valueSize);
+    auto buffer = arrow::AllocateBuffer(numBytes);
+    if (!buffer.ok()) {
+        std::ostringstream oss;
+        oss << "Error: unable to allocate " << numBytes << " bytes " << buffer.status().message();
+        throw MemoryAllocationException(oss.str());
+    }
+    return std::shared_ptr<arrow::Buffer>(buffer.MoveValueUnsafe());
+}
 
-        uint8_t *nullFlags = (uint8_t*)malloc(numberOfPoints * sizeof(uint8_t));
+std::shared_ptr<arrow::Array> castArray(std::shared_ptr<arrow::Array> array, std::shared_ptr<arrow::DataType> type) {
 
-        for( size_t i = 0 ; i < numberOfPoints ; i++ ) {
-            nullFlags[i] = fieldValues[i] != 9999;
-        }
+    if (array->type()->Equals(type)) {
+        return array;
+    }
+    auto result = cp::Cast(*array, type);
+    if (!result.ok()) {
+        throw ArrowGenericException("Unable to cast array to " + type->ToString() + " " + result.status().message());
+    }
+    return result.ValueOrDie();
+}
 
-        ARROW_RETURN_NOT_OK(valuesBuilder.AppendValues(fieldValues, numberOfPoints, nullFlags));
-    } 
-    else {
-        ARROW_RETURN_NOT_OK(valuesBuilder.AppendValues(fieldValues, numberOfPoints));
+namespace {
+
+    // Sets a bit for every value which isn't the missing value and returns the number of missing values
+    // The bits are generated 8 at a time so the comparisons can be vectorised
+    template <typename T>
+    int64_t generateValidityBitmap(const T* values, int64_t length, T missingValue, uint8_t* bitmap) {
+        int64_t i = 0;
+        int64_t validCount = 0;
+        arrow::internal::GenerateBitsUnrolled(bitmap, 0, length, [&]() -> bool {
+            bool valid = values[i++] != missingValue;
+            validCount += valid;
+            return valid;
+        });
+        return length - validCount;
     }
+}
 
-    std::shared_ptr<arrow::Array> arrayValues;
-    ARROW_ASSIGN_OR_RAISE(arrayValues, valuesBuilder.Finish());
-    return arrayValues;
+arrow::Result<std::shared_ptr<arrow::Array>> missingToNull(std::shared_ptr<arrow::Array> array, double missingValue) {
 
-//return arrow::Status::OK();
-}  
+    auto data = array->data();
+    auto length = data->length;
+    ARROW_ASSIGN_OR_RAISE(std::shared_ptr<arrow::Buffer> bitmap, arrow::AllocateBitmap(length));
 
+    int64_t nullCount;
+    if (data->type->id() == arrow::Type::FLOAT) {
+        nullCount = generateValidityBitmap(data->GetValues<float>(1), length, (float)missingValue, bitmap->mutable_data());
+    } else if (data->type->id() == arrow::Type::DOUBLE) {
+        nullCount = generateValidityBitmap(data->GetValues<double>(1), length, missingValue, bitmap->mutable_data());
+    } else {
+        return arrow::Status::TypeError("Missing values can only be replaced in float or double arrays not ", data->type->ToString());
+    }
 
-arrow::Result<std::shared_ptr<arrow::Array>> fieldToArrow(long numberOfPoints, long value ) {
+    if (nullCount == 0) {
+        return array;
+    }
 
+    //The values buffer is shared, only the validity bitmap is new
+    auto withNulls = data->Copy();
+    withNulls->buffers[0] = bitmap;
+    withNulls->null_count = nullCount;
+    return arrow::MakeArray(withNulls);
+}
 
-    arrow::UInt64Builder valuesBuilder;
+arrow::Result<std::shared_ptr<arrow::Array>> doubleFieldToArrow(long numberOfPoints, 
+            double *fieldValues, 
+            bool replaceMissingWithNull) {
 
-    std::vector<u_int64_t> column_values;
-    for(auto i =0 ; i <  numberOfPoints; ++i) {
-        column_values.emplace_back(value);
-    }
+    arrow::DoubleBuilder valuesBuilder;
+    ARROW_RETURN_NOT_OK(valuesBuilder.AppendValues(fieldValues, numberOfPoints));
 
-    ARROW_RETURN_NOT_OK(valuesBuilder.AppendValues(column_values));
     std::shared_ptr<arrow::Array> arrayValues;
-    ARROW_ASSIGN_OR_RAISE(arrayValues,valuesBuilder.Finish());
-    return arrayValues;
-
+    ARROW_ASSIGN_OR_RAISE(arrayValues, valuesBuilder.Finish());
 
-//return arrow::Status::OK();
+    if (replaceMissingWithNull) {
+        //9999 is the default missingValue of eccodes
+        return missingToNull(arrayValues, 9999);
+    }
+    return arrayValues;
 }  
 
-arrow::Result<std::shared_ptr<arrow::Array>> fieldToArrow(long numberOfPoints, u_int32_t value ) {
-
 
-    arrow::UInt32Builder valuesBuilder;
+std::shared_ptr<arrow::DataType> encodedType(std::shared_ptr<arrow::DataType> valueType, ColumnEncoding encoding) {
 
-    std::vector<u_int32_t> column_values;
-    for(auto i =0 ; i <  numberOfPoints; ++i) {
-        column_values.emplace_back(value);
+    switch (encoding) {
+        case ColumnEncoding::RunEnd:
+            return arrow::run_end_encoded(arrow::int32(), valueType);
+        case ColumnEncoding::Dictionary:
+            return arrow::dictionary(arrow::int8(), valueType);
+        default:
+            return valueType;
     }
+}
 
-    ARROW_RETURN_NOT_OK(valuesBuilder.AppendValues(column_values));
-    std::shared_ptr<arrow::Array> arrayValues;
-    ARROW_ASSIGN_OR_RAISE(arrayValues,valuesBuilder.Finish());
-    return arrayValues;
+arrow::Result<std::shared_ptr<arrow::Array>> constantToArrow(long numberOfPoints, 
+        std::shared_ptr<arrow::Scalar> value, 
+        ColumnEncoding encoding) {
+
+    switch (encoding) {
+        case ColumnEncoding::RunEnd: {
+            //A single run covering every point
+            ARROW_ASSIGN_OR_RAISE(auto values, arrow::MakeArrayFromScalar(*value, 1));
+            ARROW_ASSIGN_OR_RAISE(auto runEnds, arrow::MakeArrayFromScalar(arrow::Int32Scalar((int32_t)numberOfPoints), 1));
+            ARROW_ASSIGN_OR_RAISE(auto array, arrow::RunEndEncodedArray::Make(numberOfPoints, runEnds, values));
+            return std::static_pointer_cast<arrow::Array>(array);
+        }
+        case ColumnEncoding::Dictionary: {
+            //Every point refers to the only entry in the dictionary
+            ARROW_ASSIGN_OR_RAISE(auto dictionary, arrow::MakeArrayFromScalar(*value, 1));
+            ARROW_ASSIGN_OR_RAISE(auto indices, arrow::MakeArrayFromScalar(arrow::Int8Scalar(0), numberOfPoints));
+            return arrow::DictionaryArray::FromArrays(encodedType(value->type, encoding), indices, dictionary);
+        }
+        default:
+            return arrow::MakeArrayFromScalar(*value, numberOfPoints);
+    }
+}
 
+arrow::Result<std::shared_ptr<arrow::Array>> fieldToArrow(long numberOfPoints, long value, ColumnEncoding encoding) {
 
-//return arrow::Status::OK();
+    return constantToArrow(numberOfPoints, std::make_shared<arrow::UInt64Scalar>((u_int64_t)value), encoding);
 }  
 
-arrow::Result<std::shared_ptr<arrow::Array>> fieldToArrow(long numberOfPoints, uint8_t value ) {
+arrow::Result<std::shared_ptr<arrow::Array>> fieldToArrow(long numberOfPoints, u_int32_t value, ColumnEncoding encoding) {
 
+    return constantToArrow(numberOfPoints, std::make_shared<arrow::UInt32Scalar>(value), encoding);
+}  
 
-    arrow::UInt8Builder valuesBuilder;
-
-    std::vector<uint8_t> column_values;
-    for(auto i =0 ; i <  numberOfPoints; ++i) {
-        column_values.emplace_back(value);
-    }
-
-    ARROW_RETURN_NOT_OK(valuesBuilder.AppendValues(column_values));
-    std::shared_ptr<arrow::Array> arrayValues;
-    ARROW_ASSIGN_OR_RAISE(arrayValues,valuesBuilder.Finish());
-    return arrayValues;
-
+arrow::Result<std::shared_ptr<arrow::Array>> fieldToArrow(long numberOfPoints, uint8_t value, ColumnEncoding encoding) {
 
-//return arrow::Status::OK();
+    return constantToArrow(numberOfPoints, std::make_shared<arrow::UInt8Scalar>(value), encoding);
 }  
 
-arrow::Result<std::shared_ptr<arrow::Array>> fieldToArrow(long numberOfPoints, std::chrono::system_clock::time_point  value ) {
+arrow::Result<std::shared_ptr<arrow::Array>> fieldToArrow(long numberOfPoints, std::chrono::system_clock::time_point value, ColumnEncoding encoding) {
 
     auto timeSinceEpoch = (int64_t) std::chrono::duration_cast<std::chrono::microseconds>(value.time_since_epoch()).count() ;
 
-    std::vector<int64_t> column_values;
-    for(auto i =0 ; i <  numberOfPoints; ++i) {
-        column_values.emplace_back(timeSinceEpoch);
-    }
-
     auto timeType = arrow::timestamp(arrow::TimeUnit::MICRO);
-    arrow::TimestampBuilder valuesBuilder(timeType, arrow::default_memory_pool());
-    
-    ARROW_RETURN_NOT_OK(valuesBuilder.AppendValues(column_values));
-    std::shared_ptr<arrow::Array> arrayValues;
-    ARROW_ASSIGN_OR_RAISE(arrayValues,valuesBuilder.Finish());
-    return arrayValues;
-
-//return arrow::Status::OK();
-}
\ No newline at end of file
+    return constantToArrow(numberOfPoints, std::make_shared<arrow::TimestampScalar>(timeSinceEpoch, timeType), encoding);
+}
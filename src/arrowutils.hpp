@@ -16,13 +16,37 @@ arrow::Result<std::vector<data_row>> ColumnarTableToVector(
     const std::shared_ptr<arrow::Table>& table);
 
 
+// Allocates an uninitialised buffer from the arrow memory pool which can hold numberOfPoints values of valueSize bytes
+std::shared_ptr<arrow::Buffer> allocateBuffer(long numberOfPoints, size_t valueSize);
+
+// Casts the array to type, returns the array unchanged if it is already of that type
+std::shared_ptr<arrow::Array> castArray(std::shared_ptr<arrow::Array> array, std::shared_ptr<arrow::DataType> type);
+
+// Marks every value of a float or double array which equals missingValue as null
+// The values are shared with array, only a validity bitmap is created (and only when something is missing)
+arrow::Result<std::shared_ptr<arrow::Array>> missingToNull(std::shared_ptr<arrow::Array> array, double missingValue);
+
 arrow::Result<std::shared_ptr<arrow::Array>> doubleFieldToArrow(long numberOfPoints, 
         double *fieldValues, 
         bool replaceMissingWithNull);
 
-arrow::Result<std::shared_ptr<arrow::Array>> fieldToArrow(long numberOfPoints, long value );
-arrow::Result<std::shared_ptr<arrow::Array>> fieldToArrow(long numberOfPoints, u_int32_t value ) ;
-arrow::Result<std::shared_ptr<arrow::Array>> fieldToArrow(long numberOfPoints, uint8_t value );
-arrow::Result<std::shared_ptr<arrow::Array>> fieldToArrow(long numberOfPoints, std::chrono::system_clock::time_point  value ) ;
+// How a column which has the same value for every point of a message is stored
+// Dense - the value is repeated for every point
+// RunEnd - a run end encoded array holding the value once
+// Dictionary - a dictionary array with a single entry (the indices are one byte per point)
+enum class ColumnEncoding { Dense, RunEnd, Dictionary };
+
+// The type of a column of valueType stored with encoding
+std::shared_ptr<arrow::DataType> encodedType(std::shared_ptr<arrow::DataType> valueType, ColumnEncoding encoding);
+
+// A column of numberOfPoints copies of value
+arrow::Result<std::shared_ptr<arrow::Array>> constantToArrow(long numberOfPoints, 
+        std::shared_ptr<arrow::Scalar> value, 
+        ColumnEncoding encoding);
+
+arrow::Result<std::shared_ptr<arrow::Array>> fieldToArrow(long numberOfPoints, long value, ColumnEncoding encoding = ColumnEncoding::Dense);
+arrow::Result<std::shared_ptr<arrow::Array>> fieldToArrow(long numberOfPoints, u_int32_t value, ColumnEncoding encoding = ColumnEncoding::Dense);
+arrow::Result<std::shared_ptr<arrow::Array>> fieldToArrow(long numberOfPoints, uint8_t value, ColumnEncoding encoding = ColumnEncoding::Dense);
+arrow::Result<std::shared_ptr<arrow::Array>> fieldToArrow(long numberOfPoints, std::chrono::system_clock::time_point value, ColumnEncoding encoding = ColumnEncoding::Dense);
 
 #endif /* ARROW_UTILS_INCLUDED */
\ No newline at end of file
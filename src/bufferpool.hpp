@@ -0,0 +1,58 @@
+#ifndef BUFFER_POOL_H_INCLUDED
+#define BUFFER_POOL_H_INCLUDED
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Scratch buffers owned by a reader so a field decoded for every message isn't allocated for every message.
+// A buffer goes back to the pool when the last reference to it is dropped. The pool keeps at most maxIdle buffers
+// (one per decoding thread) and frees the rest, the buffers it keeps are freed with the pool rather than with a thread.
+template <typename T>
+class BufferPool : public std::enable_shared_from_this<BufferPool<T>>
+{
+    public:
+
+        BufferPool(size_t maxIdle) : maxIdle(maxIdle) {}
+
+        // A buffer of size elements whose contents are unspecified
+        std::shared_ptr<std::vector<T>> acquire(size_t size) {
+            std::unique_ptr<std::vector<T>> buffer;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!idle.empty()) {
+                    buffer = std::move(idle.back());
+                    idle.pop_back();
+                }
+            }
+            if (!buffer) {
+                buffer = std::make_unique<std::vector<T>>();
+            }
+            buffer->resize(size);
+
+            //A buffer released after the pool has gone is just freed
+            std::weak_ptr<BufferPool<T>> pool = this->shared_from_this();
+            return std::shared_ptr<std::vector<T>>(buffer.release(), [pool](std::vector<T>* released) {
+                std::unique_ptr<std::vector<T>> owned(released);
+                if (auto owner = pool.lock()) {
+                    owner->release(std::move(owned));
+                }
+            });
+        }
+
+    private:
+
+        std::mutex mutex;
+        size_t maxIdle;
+        std::vector<std::unique_ptr<std::vector<T>>> idle;
+
+        void release(std::unique_ptr<std::vector<T>> buffer) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (idle.size() < maxIdle) {
+                idle.push_back(std::move(buffer));
+            }
+        }
+};
+
+#endif /*BUFFER_POOL_H_INCLUDED*/
@@ -53,5 +53,29 @@ namespace pybind11 { namespace detail {
     template <>
     struct type_caster<std::shared_ptr<arrow::Table>> : public table_type_caster<arrow::Table> {
     };
+
+
+    template <typename DataType> struct data_type_caster {
+    public:
+        PYBIND11_TYPE_CASTER(std::shared_ptr<arrow::DataType>, _("pyarrow::DataType"));
+        // Python -> C++
+        bool load(handle src, bool) {
+            PyObject *source = src.ptr();
+            if (!arrow::py::is_data_type(source))
+                return false;
+            arrow::Result<std::shared_ptr<arrow::DataType>> result = arrow::py::unwrap_data_type(source);
+            if(!result.ok())
+                return false;
+            value = result.ValueOrDie();
+            return true;
+        }
+        // C++ -> Python
+        static handle cast(std::shared_ptr<arrow::DataType> src, return_value_policy , handle ) {
+            return arrow::py::wrap_data_type(src);
+        }
+    };
+    template <>
+    struct type_caster<std::shared_ptr<arrow::DataType>> : public data_type_caster<arrow::DataType> {
+    };
 }}
 
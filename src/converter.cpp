@@ -1,23 +1,58 @@
 #include "converter.hpp"
+#include <algorithm>
 #include <arrow/api.h>
-#include <arrow/compute/api.h>
 #include <iostream>
 
 using namespace std;
 
-Converter::Converter(std::function<arrow::Result<arrow::Datum>(arrow::Datum, arrow::Datum)> conversionFunc,
-                    double conversionValue) : conversionFunc(conversionFunc), conversionValue(conversionValue) { }
+Converter::Converter(std::optional<double> additionValue,
+                     std::optional<double> subtractionValue,
+                     std::optional<double> multiplicationValue,
+                     std::optional<double> divisionValue,
+                     std::optional<double> ceilingValue) : ceiling(ceilingValue) {
+
+    //(x + a) * m / d - s is x * (m / d) + (a * (m / d) - s)
+    scale = multiplicationValue.value_or(1.0) / divisionValue.value_or(1.0);
+    offset = additionValue.value_or(0.0) * scale - subtractionValue.value_or(0.0);
+}
+
+template <typename T>
+void Converter::convert(T* values, int64_t length) const {
+    //The values are widened to double for the arithmetic, the loops have no branches so the compiler can vectorise them
+    if (ceiling.has_value()) {
+        auto limit = ceiling.value();
+        for (int64_t i = 0; i < length; i++) {
+            //std::min returns its first argument when the comparison is false so a NaN value stays NaN
+            values[i] = (T)std::min(values[i] * scale + offset, limit);
+        }
+    } else {
+        for (int64_t i = 0; i < length; i++) {
+            values[i] = (T)(values[i] * scale + offset);
+        }
+    }
+}
 
 arrow::Result<std::shared_ptr<arrow::Array>> Converter::operator () (std::shared_ptr<arrow::Array> valuesArray) {
 
-    shared_ptr<arrow::Scalar> operand(new arrow::DoubleScalar(conversionValue));
-    arrow::Datum datum;
+    auto type = valuesArray->type_id();
+    if (type != arrow::Type::DOUBLE && type != arrow::Type::FLOAT) {
+        return arrow::Status::TypeError("Conversions can only be applied to float32 or float64 values not ", 
+                                        valuesArray->type()->ToString());
+    }
 
-    ARROW_ASSIGN_OR_RAISE(datum,
-             conversionFunc(valuesArray, operand));
+    //The validity bitmap is kept as it is so null slots are converted too but stay null
+    auto data = valuesArray->data();
+    if (!data->buffers[1]->is_mutable()) {
+        ARROW_ASSIGN_OR_RAISE(auto copy, data->buffers[1]->CopySlice(0, data->buffers[1]->size()));
+        data = data->Copy();
+        data->buffers[1] = copy;
+    }
 
-    std::shared_ptr<arrow::Array> new_values = std::move(datum).make_array();
+    if (type == arrow::Type::DOUBLE) {
+        convert(data->GetMutableValues<double>(1), data->length);
+    } else {
+        convert(data->GetMutableValues<float>(1), data->length);
+    }
 
-    return new_values;
-            
-}
\ No newline at end of file
+    return arrow::MakeArray(data);
+}
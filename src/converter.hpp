@@ -1,22 +1,36 @@
 #ifndef CONVERTER_INCLUDED
 #define CONVERTER_INCLUDED
 
+#include <optional>
 #include <arrow/api.h>
 
+// Converts the values of a parameter using every operation of its row in the conversions table
+//   min(ceiling, (x + addition) * multiplication / division - subtraction)
+// Missing operations are left out. The operations are folded into a single scale and offset when the
+// converter is created so the values are converted in one pass.
 class Converter
 {
 
     
 public:
 
-    std::function<arrow::Result<arrow::Datum>(arrow::Datum, arrow::Datum)> conversionFunc;
-    double conversionValue;
-
-    Converter(std::function<arrow::Result<arrow::Datum>(arrow::Datum, arrow::Datum)> conversionFunc, double conversionValue);
+    Converter(std::optional<double> additionValue,
+              std::optional<double> subtractionValue,
+              std::optional<double> multiplicationValue,
+              std::optional<double> divisionValue,
+              std::optional<double> ceilingValue);
  
-    // This operator overloading enables calling
-    // operator function () on objects of increment
+    // Converts the values in place (or a copy when the buffer can't be written to), nulls are left as they are
     arrow::Result<std::shared_ptr<arrow::Array>> operator () (std::shared_ptr<arrow::Array> valuesArray);
+
+private:
+
+    double scale;
+    double offset;
+    std::optional<double> ceiling;
+
+    template <typename T>
+    void convert(T* values, int64_t length) const;
 };
 
-#endif /* CONVERTER_INCLUDED */
\ No newline at end of file
+#endif /* CONVERTER_INCLUDED */
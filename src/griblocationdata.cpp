@@ -1,14 +1,22 @@
 #include "griblocationdata.hpp"
 #include <arrow/api.h>
+#include <arrow/util/byte_size.h>
+#include <arrow/compute/api.h>
+#include "exceptions/arrowgenericexception.hpp"
+
+namespace cp = arrow::compute;
 
         GribLocationData::GribLocationData(long numberOfPoints,
-                     int* indexes,
+                     std::shared_ptr<arrow::Buffer> indexes,
                         arrow::Result<std::shared_ptr<arrow::Array>> latsArray,
                         arrow::Result<std::shared_ptr<arrow::Array>> lonsArray,
                         arrow::Result<std::shared_ptr<arrow::Array>> distanceArray,
                         arrow::Result<std::shared_ptr<arrow::Array>> outlatsArray,
                         arrow::Result<std::shared_ptr<arrow::Array>> outlonsArray,
-                        std::shared_ptr<arrow::RecordBatch> tableData) : 
+                        std::shared_ptr<arrow::RecordBatch> tableData,
+                        std::shared_ptr<arrow::Table> locations,
+                        std::shared_ptr<arrow::Int64Array> selection,
+                        std::shared_ptr<InterpolationWeights> interpolationWeights) : 
                         numberOfPoints(numberOfPoints), 
                         indexes(indexes),
                         latsArray(latsArray),
@@ -16,4 +24,78 @@
                         distanceArray(distanceArray),
                         outlatsArray(outlatsArray),
                         outlonsArray(outlonsArray),
-                        tableData(tableData) {}
\ No newline at end of file
+                        tableData(tableData),
+                        locations(locations),
+                        selection(selection),
+                        interpolationWeights(interpolationWeights) {}
+
+        uint64_t GribLocationData::getSizeInBytes() const {
+            uint64_t bytes = indexes ? indexes->size() : 0;
+            for (auto array : {distanceArray, outlatsArray, outlonsArray}) {
+                if (array.ok()) {
+                    bytes += arrow::util::TotalBufferSize(*array.ValueOrDie());
+                }
+            }
+            //Without a selection the columns in tableData are those of the reader
+            if (selection) {
+                bytes += arrow::util::TotalBufferSize(*selection);
+                if (tableData) {
+                    bytes += arrow::util::TotalBufferSize(*tableData);
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(gatheredMutex);
+                bytes += gatheredBytes;
+            }
+            if (interpolationWeights) {
+                bytes += interpolationWeights->indexes.size() * sizeof(int) + interpolationWeights->weights.size() * sizeof(double);
+            }
+            return bytes;
+        }
+
+        std::shared_ptr<arrow::Array> GribLocationData::getLocationColumn(const std::string& name, bool* gathered) {
+            if (auto column = tableData->GetColumnByName(name)) {
+                return column;
+            }
+            std::lock_guard<std::mutex> lock(gatheredMutex);
+            if (auto found = gatheredColumns.find(name); found != gatheredColumns.end()) {
+                return found->second;
+            }
+            auto column = locations->GetColumnByName(name);
+            if (!column) {
+                return nullptr;
+            }
+            auto result = gatherColumn(column, selection);
+            //A single chunk without a selection is the column of the reader so isn't counted
+            if (selection || column->num_chunks() != 1) {
+                gatheredBytes += arrow::util::TotalBufferSize(*result);
+                if (gathered) {
+                    *gathered = true;
+                }
+            }
+            gatheredColumns.emplace(name, result);
+            return result;
+        }
+
+        std::shared_ptr<arrow::Array> GribLocationData::gatherColumn(std::shared_ptr<arrow::ChunkedArray> column,
+                                                                     std::shared_ptr<arrow::Int64Array> selection) {
+            if (selection) {
+                auto result = cp::Take(column, selection);
+                if (!result.ok()) {
+                    throw ArrowGenericException("Unable to select the locations in the area " + result.status().message());
+                }
+                column = result.ValueOrDie().chunked_array();
+            }
+            if (column->num_chunks() == 0) {
+                return arrow::MakeEmptyArray(column->type()).ValueOrDie();
+            }
+            //A single chunk (the usual case) isn't copied
+            if (column->num_chunks() == 1) {
+                return column->chunk(0);
+            }
+            auto combined = arrow::Concatenate(column->chunks());
+            if (!combined.ok()) {
+                throw ArrowGenericException("Unable to combine the locations " + combined.status().message());
+            }
+            return combined.ValueOrDie();
+        }
@@ -2,6 +2,9 @@
 #define GRIB_LOCATION_H_INCLUDED
 
 #include <utility>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <memory>
 #include <iostream>
 #include <chrono>
@@ -12,6 +15,7 @@
 #include "eccodes.h"
 #include "gribreader.hpp"
 #include "caster.hpp"
+#include "interpolation.hpp"
 
 
 using namespace std;
@@ -22,27 +26,56 @@ class GribLocationData
     public:
 
         long numberOfPoints;
-        std::unique_ptr<int> indexes;
+        //The index of the nearest grid point of each location (int values)
+        std::shared_ptr<arrow::Buffer> indexes;
         arrow::Result<std::shared_ptr<arrow::Array>> latsArray;
         arrow::Result<std::shared_ptr<arrow::Array>> lonsArray;
         arrow::Result<std::shared_ptr<arrow::Array>> distanceArray;
         arrow::Result<std::shared_ptr<arrow::Array>> outlatsArray;
         arrow::Result<std::shared_ptr<arrow::Array>> outlonsArray;
+        //The lat, lon and surrogate_key of the locations in the grid, the other columns are gathered by getLocationColumn
         std::shared_ptr<arrow::RecordBatch> tableData;
+        //The locations of the reader, shared rather than copied for each grid
+        std::shared_ptr<arrow::Table> locations;
+        //The rows of the locations in the grid, nullptr when every location is in the grid
+        std::shared_ptr<arrow::Int64Array> selection;
+        //The stencils used to interpolate the value at each location, nullptr uses the nearest point
+        std::shared_ptr<InterpolationWeights> interpolationWeights;
 
 
         GribLocationData(long numberOfPoints,
-                        int* indexes,
+                        std::shared_ptr<arrow::Buffer> indexes,
                         arrow::Result<std::shared_ptr<arrow::Array>> latsArray,
                         arrow::Result<std::shared_ptr<arrow::Array>> lonsArray,
                         arrow::Result<std::shared_ptr<arrow::Array>> distanceArray,
                         arrow::Result<std::shared_ptr<arrow::Array>> outlatsArray,
                         arrow::Result<std::shared_ptr<arrow::Array>> outlonsArray,
-                        std::shared_ptr<arrow::RecordBatch> tableData);
+                        std::shared_ptr<arrow::RecordBatch> tableData,
+                        std::shared_ptr<arrow::Table> locations,
+                        std::shared_ptr<arrow::Int64Array> selection,
+                        std::shared_ptr<InterpolationWeights> interpolationWeights = nullptr);
+
+        //The column of the locations in the grid, nullptr if the locations don't have it
+        //Columns other than those in tableData are gathered the first time they are asked for and kept with the grid,
+        //gathered is set when this call copied a column so the caller can update the size of the cache
+        std::shared_ptr<arrow::Array> getLocationColumn(const std::string& name, bool* gathered = nullptr);
+
+        //A single array with the rows of the column in the selection (or every row without one)
+        static std::shared_ptr<arrow::Array> gatherColumn(std::shared_ptr<arrow::ChunkedArray> column,
+                                                          std::shared_ptr<arrow::Int64Array> selection);
+
+        //The memory used by the buffers, columns shared with the reader aren't counted
+        uint64_t getSizeInBytes() const;
         
 
     private:
 
+        //Guards the gathered columns as messages of the grid may be decoded on multiple threads
+        mutable std::mutex gatheredMutex;
+        std::unordered_map<std::string, std::shared_ptr<arrow::Array>> gatheredColumns;
+        //The bytes of the gathered columns which are copies rather than columns of the reader
+        uint64_t gatheredBytes = 0;
+
    
 };
 
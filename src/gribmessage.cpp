@@ -13,11 +13,34 @@
 #include "arrowutils.hpp"
 #include "exceptions/gribexception.hpp"
 #include "exceptions/memoryallocationexception.hpp"
+#include "exceptions/codesgetdoublevaluesasarrayexception.hpp"
+#include "exceptions/invalidschemaexception.hpp"
+#include "exceptions/arrowgenericexception.hpp"
 #include <type_traits>
 #include <limits>
+#include <algorithm>
+#include <numeric>
+#include <arrow/compute/api.h>
 
 using namespace std;
+namespace cp = arrow::compute;
 
+namespace {
+
+    //The number of locations matched to a grid at a time
+    const long LOCATION_BLOCK_SIZE = 65536;
+
+    std::optional<double> keyAsDouble(const KeyValue& value) {
+        if (auto longValue = std::get_if<long>(&value)) {
+            return (double)*longValue;
+        }
+        if (auto doubleValue = std::get_if<double>(&value)) {
+            return *doubleValue;
+        }
+        return std::nullopt;
+    }
+
+}
 
     GribMessage::GribMessage(GribReader* reader, 
                             codes_handle* codes_handle,
@@ -27,9 +50,7 @@ using namespace std;
                                         _message_id(message_id)
                                         { 
         if (codes_handle != NULL && codes_handle != NULLPTR) {
-            gribVersion = this->getEditionNumber();  
-            longitudeOfFirstGridPointInDegrees = this->getLongitudeOfFirstPoint();
-            longitudeOfLastGridPointInDegrees = this->getLongitudeOfLastPoint(); 
+            metadata = readMessageMetadata(h);
         }
     }
 
@@ -53,28 +74,31 @@ using namespace std;
 
 
     double GribMessage::getLatitudeOfFirstPoint() {
-        return getDoubleParameter("latitudeOfFirstGridxPointInDegrees");
+        return metadata.latitudeOfFirstPoint ? *metadata.latitudeOfFirstPoint 
+                                             : getDoubleParameter("latitudeOfFirstGridPointInDegrees");
     }
 
     double GribMessage::getLongitudeOfFirstPoint() {
-        return getDoubleParameter("longitudeOfFirstGridPointInDegrees");
+        return metadata.longitudeOfFirstPoint ? *metadata.longitudeOfFirstPoint 
+                                              : getDoubleParameter("longitudeOfFirstGridPointInDegrees");
     }
 
     double GribMessage::getLatitudeOfLastPoint() {
-        return getDoubleParameter("latitudeOfLastGridPointInDegrees");
+        return metadata.latitudeOfLastPoint ? *metadata.latitudeOfLastPoint 
+                                            : getDoubleParameter("latitudeOfLastGridPointInDegrees");
     }
 
     double GribMessage::getLongitudeOfLastPoint() {
-        return getDoubleParameter("longitudeOfLastGridPointInDegrees");
+        return metadata.longitudeOfLastPoint ? *metadata.longitudeOfLastPoint 
+                                             : getDoubleParameter("longitudeOfLastGridPointInDegrees");
     }
 
     double GribMessage::getStandardisedLongitudeOfFirstPoint() {
 
-        auto longitude = longitudeOfFirstGridPointInDegrees;
+        auto longitude = getLongitudeOfFirstPoint();
 
-        cout << "longitudeOfFirstPoint = " << longitude << endl; 
         //Grib version 2 always has longitude as positive values
-        if (gribVersion == 2l) {
+        if (getEditionNumber() == 2l) {
             if (longitude >= 180 && longitude <= 360.0) {
                 longitude = longitude - 360;
             }
@@ -82,18 +106,15 @@ using namespace std;
                 longitude = longitude - 180;
             } 
         }
-        cout << "converted longitudeOfFirstPoint = " << longitude << endl; 
         return longitude;
     }
     double GribMessage::getStandardisedLongitudeOfLastPoint() {
 
+        auto longitude = getLongitudeOfLastPoint();
+        auto longitudeOfFirstPoint = getLongitudeOfFirstPoint();
 
-        auto longitude = this->getLongitudeOfLastPoint();
-
-        cout << "longitudeOfLastPoint = " << longitude << endl; 
-
-        if (gribVersion == 2l) {
-            if (longitudeOfFirstGridPointInDegrees >= 180 && longitudeOfFirstGridPointInDegrees <= 360.0) {
+        if (getEditionNumber() == 2l) {
+            if (longitudeOfFirstPoint >= 180 && longitudeOfFirstPoint <= 360.0) {
                 longitude = longitude - 360;
             }
             else {
@@ -101,8 +122,6 @@ using namespace std;
             } 
         }
 
-        cout << "converted longitudeOfLastPoint = " << longitude << endl;
-
         return longitude;
     }
 
@@ -119,16 +138,8 @@ using namespace std;
     }
 
     chrono::system_clock::time_point GribMessage::getChronoDate() {
-        tm tm = {};
-        string date = to_string(getDateNumeric());
-
-        //stringstream ss(date);
-        strptime(date.c_str(), "%Y%m%d", &tm);
-        auto forecastTime = getTimeNumeric() / 100;
-        auto chronoDate =  std::chrono::system_clock::from_time_t(std::mktime(&tm));
-        chronoDate += std::chrono::hours(forecastTime);
-        return chronoDate;
-
+        //Grib dates are UTC so don't go via mktime which uses the local time zone
+        return toTimePoint(getDateNumeric(), getTimeNumeric());
     }
 
     chrono::system_clock::time_point GribMessage::getObsDate() {
@@ -147,25 +158,25 @@ using namespace std;
     }
 
     long GribMessage::getDateNumeric() { 
-        return getNumericParameter("date");
+        return metadata.date ? *metadata.date : getNumericParameter("date");
     }
 
     long GribMessage::getTimeNumeric() { 
-        return getNumericParameter("time");
+        return metadata.time ? *metadata.time : getNumericParameter("time");
     }
 
     long GribMessage::getParameterId() {
-        return getNumericParameter("paramId");
+        return metadata.parameterId ? *metadata.parameterId : getNumericParameter("paramId");
     }
 
     long GribMessage::getModelNumber() {
         //Had some issues with this key missing 
         //maybe it isn't mandatory so use this method
-        return getNumericParameterOrDefault("number", 0l);
+        return metadata.number.value_or(0l);
     }
 
     long GribMessage::getStep() {
-        return getNumericParameter("step");
+        return metadata.step ? *metadata.step : getNumericParameter("step");
     }
 
     string GribMessage::getStepUnits() {
@@ -181,11 +192,11 @@ using namespace std;
     }
 
     long GribMessage::getEditionNumber() { 
-        return getNumericParameter("editionNumber");
+        return metadata.editionNumber ? *metadata.editionNumber : getNumericParameter("editionNumber");
     }
 
     long GribMessage::getNumberOfPoints() {
-        return getNumericParameter("numberOfPoints");
+        return metadata.numberOfPoints ? *metadata.numberOfPoints : getNumericParameter("numberOfPoints");
     }
 
     long GribMessage::getGridDefinitionTemplateNumber() {
@@ -193,70 +204,380 @@ using namespace std;
     }
 
     bool GribMessage::iScansNegatively() {
-        return (int)getNumericParameter("iScansNegatively") == 1 ;
+        return (metadata.iScansNegatively ? *metadata.iScansNegatively : getNumericParameter("iScansNegatively")) == 1;
     }
     
     bool GribMessage::jScansPositively() {
-        return (int)getNumericParameter("jScansPositively") == 1 ;
+        return (metadata.jScansPositively ? *metadata.jScansPositively : getNumericParameter("jScansPositively")) == 1;
     }
 
-    std::shared_ptr<arrow::Table> GribMessage::getData() {
+    std::shared_ptr<arrow::Schema> GribMessage::getDataSchema(std::shared_ptr<arrow::DataType> valueType) {
+        return arrow::schema({arrow::field("Latitudes", valueType),
+                              arrow::field("Longitudes", valueType),
+                              arrow::field("Values", valueType)});
+    }
 
-        double *lats, *lons, *values; /* arrays */
-        long numberOfPoints = getNumberOfPoints();
+    arrow::FieldVector GribMessage::getMessageFields(ColumnEncoding encoding) {
+        return {arrow::field("parameterId", encodedType(arrow::uint32(), encoding)),
+                arrow::field("modelNo", encodedType(arrow::uint8(), encoding)),
+                arrow::field("forecast_date", encodedType(arrow::timestamp(arrow::TimeUnit::MICRO), encoding)),
+                arrow::field("datetime", encodedType(arrow::timestamp(arrow::TimeUnit::MICRO), encoding))};
+    }
 
-        lats = (double*)malloc(numberOfPoints * sizeof(double));
-        if (!lats) {
-            auto numBytes = (long)(numberOfPoints * sizeof(double));
-                       std::ostringstream oss;
-                        oss << "Error: unable to allocate " << numBytes << " bytes";
- 
-                throw MemoryAllocationException(oss.str());
+    arrow::ArrayVector GribMessage::getMessageColumns(long numberOfPoints) {
+        arrow::ArrayVector columns;
+        for (auto field : getMessageFields(_reader->getConstantColumnEncoding())) {
+            columns.push_back(getMessageColumn(field->name(), numberOfPoints));
         }
-        lons = (double*)malloc(numberOfPoints * sizeof(double));
-        if (!lons) {
-            auto numBytes = (long)(numberOfPoints * sizeof(double));
-                       std::ostringstream oss;
-                        oss << "Error: unable to allocate " << numBytes << " bytes";
- 
-                throw MemoryAllocationException(oss.str());
-            free(lats);
-        }
-        values = (double*)malloc(numberOfPoints * sizeof(double));
-        if (!values) {
-            auto numBytes = (long)(numberOfPoints * sizeof(double));
-                       std::ostringstream oss;
-                        oss << "Error: unable to allocate " << numBytes << " bytes";
- 
-                throw MemoryAllocationException(oss.str());
-            free(lats);
-            free(lons);
-            //return 1;
+        return columns;
+    }
+
+    std::shared_ptr<arrow::Array> GribMessage::getMessageColumn(std::string name, long numberOfPoints) {
+        auto encoding = _reader->getConstantColumnEncoding();
+        if (name == "parameterId") {
+            return fieldToArrow(numberOfPoints, (u_int32_t)getParameterId(), encoding).ValueOrDie();
+        } else if (name == "modelNo") {
+            return fieldToArrow(numberOfPoints, (u_int8_t) getModelNumber(), encoding).ValueOrDie();
+        } else if (name == "forecast_date") {
+            return fieldToArrow(numberOfPoints, getChronoDate(), encoding).ValueOrDie();
+        } else if (name == "datetime") {
+            return fieldToArrow(numberOfPoints, getObsDate(), encoding).ValueOrDie();
         }
-        
-        CODES_CHECK(codes_grib_get_data(h, lats, lons, values), 0);
+        throw InvalidSchemaException("Column " + name + " is not a message column");
+    }
 
-        auto valuesArray = doubleFieldToArrow(numberOfPoints, values, false);
-        auto latsArray = doubleFieldToArrow(numberOfPoints, lats, false);
-        auto lonsArray = doubleFieldToArrow(numberOfPoints, lons, false);
+    std::shared_ptr<arrow::Schema> GribMessage::getDataWithLocationsSchema(std::shared_ptr<arrow::Schema> locationSchema,
+                                                                         std::shared_ptr<arrow::DataType> valueType,
+                                                                         ColumnEncoding encoding) {
+        //Add all the fields from our lookup table first
+        arrow::FieldVector fields = locationSchema->fields();
 
-        std::shared_ptr<arrow::Field> field_lats, field_lons, field_values;
-        std::shared_ptr<arrow::Schema> schema;
+        for (auto field : getMessageFields(encoding)) {
+            fields.push_back(field);
+        }
+        //Now add the data from the lookups and grib data.
+        fields.push_back(arrow::field("distance", valueType));
+        fields.push_back(arrow::field("nearestlatitude", valueType));
+        fields.push_back(arrow::field("nearestlongitude", valueType));
+        fields.push_back(arrow::field("value", valueType));
 
-        // Every field needs its name and data type.
-        field_lats = arrow::field("Latitudes", arrow::float64());
-        field_lons = arrow::field("Longitudes", arrow::float64());
-        field_values = arrow::field("Values", arrow::float64());
+        return arrow::schema(fields);
+    }
+
+    arrow::FieldVector GribMessage::selectFields(std::shared_ptr<arrow::Schema> schema, const std::vector<std::string>& columns) {
+
+        if (columns.empty()) {
+            return schema->fields();
+        }
+
+        arrow::FieldVector fields;
+        for (auto& column : columns) {
+            auto field = schema->GetFieldByName(column);
+            if (field == nullptr) {
+                std::ostringstream oss;
+                oss << "Column " << column << " is not available, the available columns are ";
+                for (auto& name : schema->field_names()) {
+                    oss << name << " ";
+                }
+                throw InvalidSchemaException(oss.str());
+            }
+            fields.push_back(field);
+        }
+        return fields;
+    }
 
-        // The schema can be built from a vector of fields, and we do so here.
-        schema = arrow::schema({field_lats, field_lons, field_values});
+    std::shared_ptr<arrow::Table> GribMessage::selectPrefetched(std::shared_ptr<arrow::Table> table, 
+                                                                const std::vector<std::string>& columns) {
+
+        if (!table) {
+            return nullptr;
+        }
+        std::vector<int> indices;
+        for (auto& column : columns) {
+            auto index = table->schema()->GetFieldIndex(column);
+            if (index < 0) {
+                return nullptr;
+            }
+            indices.push_back(index);
+        }
+        auto result = table->SelectColumns(indices);
+        return result.ok() ? result.ValueOrDie() : nullptr;
+    }
+
+    void GribMessage::prefetch() {
+        if (_reader->hasLocations()) {
+            prefetchedLocationData = getDataWithLocations();
+        } else {
+            prefetchedData = getData();
+        }
+    }
+
+    std::shared_ptr<arrow::Table> GribMessage::getData(std::vector<std::string> columns) {
+
+        auto valueType = _reader->getValueType();
+
+        //Latitudes, Longitudes and Values unless the caller or the reader asks for something else
+        if (columns.empty()) {
+            columns = _reader->getColumns();
+        }
+        if (columns.empty()) {
+            columns = getDataSchema(valueType)->field_names();
+        }
+
+        if (auto prefetched = selectPrefetched(prefetchedData, columns)) {
+            return prefetched;
+        }
+
+        auto dataFields = getDataSchema(valueType)->fields();
+        for (auto field : getMessageFields(_reader->getConstantColumnEncoding())) {
+            dataFields.push_back(field);
+        }
+        auto fields = selectFields(arrow::schema(dataFields), columns);
+
+        auto isSelected = [&columns](std::string name) {
+            return std::find(columns.begin(), columns.end(), name) != columns.end();
+        };
+        bool coordinatesSelected = isSelected("Latitudes") || isSelected("Longitudes");
+        bool valuesSelected = isSelected("Values");
+
+        long numberOfPoints = getNumberOfPoints();
+
+        std::optional<GridCoordinates> coordinates;
+        std::shared_ptr<arrow::Array> valuesArray;
+
+        if (coordinatesSelected) {
+            //When the coordinates have to be decoded the values come with them
+            coordinates = getCoordinates(valuesSelected ? &valuesArray : nullptr);
+        }
+
+        if (valuesSelected && !valuesArray) {
+            //Every message on this grid has the same coordinates so only the values need decoding
+            valuesArray = getValues(numberOfPoints);
+        }
+
+        arrow::ArrayVector arrays;
+        for (auto& field : fields) {
+            auto name = field->name();
+            if (name == "Latitudes") {
+                arrays.push_back(coordinates->latitudes);
+            } else if (name == "Longitudes") {
+                arrays.push_back(coordinates->longitudes);
+            } else if (name == "Values") {
+                arrays.push_back(valuesArray);
+            } else {
+                arrays.push_back(getMessageColumn(name, numberOfPoints));
+            }
+        }
 
-        auto table = arrow::Table::Make(schema, {latsArray.ValueOrDie(), 
-                                lonsArray.ValueOrDie(), valuesArray.ValueOrDie()}, numberOfPoints);
+        auto table = arrow::Table::Make(arrow::schema(fields), arrays, numberOfPoints);
 
         return table;
     }
 
+    GridCoordinates GribMessage::getCoordinates(std::shared_ptr<arrow::Array>* decodedValues) {
+
+        auto valueType = _reader->getValueType();
+        long numberOfPoints = getNumberOfPoints();
+
+        //Grids without corner points (eg unstructured grids) can't be identified so aren't cached
+        std::unique_ptr<GridArea> gridArea;
+        try {
+            gridArea = getGridArea();
+        } catch (GribException& e) {
+            gridArea = nullptr;
+        }
+
+        if (gridArea) {
+            if (auto cached = _reader->getCoordinatesFromCache(gridArea)) {
+                return cached.value();
+            }
+        }
+
+        //eccodes writes straight into the arrow buffers so the arrays don't need another copy
+        auto latsBuffer = allocateBuffer(numberOfPoints, sizeof(double));
+        auto lonsBuffer = allocateBuffer(numberOfPoints, sizeof(double));
+        auto valuesBuffer = allocateBuffer(numberOfPoints, sizeof(double));
+
+        auto err = codes_grib_get_data(h, 
+                                       (double*)latsBuffer->mutable_data(), 
+                                       (double*)lonsBuffer->mutable_data(), 
+                                       (double*)valuesBuffer->mutable_data());
+        if (err != 0) {
+            std::ostringstream oss;
+            oss << "Error calling codes_grib_get_data got error code " << err
+             << " whilst processing message id " << _message_id
+             << " whilst processing file " << _reader->getFilePath();
+
+            throw GribException (oss.str());
+        }
+
+        if (decodedValues) {
+            *decodedValues = castArray(withMissingValues(std::make_shared<arrow::DoubleArray>(numberOfPoints, valuesBuffer)), 
+                                       valueType);
+        }
+        //The coordinates are only narrowed once per grid as the cache holds the value type
+        GridCoordinates coordinates {castArray(std::make_shared<arrow::DoubleArray>(numberOfPoints, latsBuffer), valueType),
+                                     castArray(std::make_shared<arrow::DoubleArray>(numberOfPoints, lonsBuffer), valueType)};
+        if (gridArea) {
+            coordinates = _reader->addCoordinatesToCache(gridArea, coordinates);
+        }
+        return coordinates;
+    }
+
+    std::vector<int> GribMessage::getAreaIndexes(double north, double west, double south, double east) {
+
+        auto keys = readKeys({"gridType", "Ni", "Nj",
+                              "latitudeOfFirstGridPointInDegrees", "longitudeOfFirstGridPointInDegrees",
+                              "iDirectionIncrementInDegrees", "jDirectionIncrementInDegrees",
+                              "iScansNegatively", "jScansPositively", "jPointsAreConsecutive",
+                              "latitudeOfSouthernPoleInDegrees", "longitudeOfSouthernPoleInDegrees", "angleOfRotationInDegrees"});
+        auto asDouble = [&keys](size_t k) { return keyAsDouble(keys[k]); };
+        auto gridType = std::holds_alternative<std::string>(keys[0]) ? std::get<std::string>(keys[0]) : "";
+
+        bool hasGeometry = true;
+        for (size_t k = 1; k < 10; k++) {
+            hasGeometry = hasGeometry && asDouble(k).has_value();
+        }
+
+        if (hasGeometry && (gridType == "regular_ll" || gridType == "rotated_ll")) {
+            RegularGrid grid {(long)*asDouble(1), (long)*asDouble(2), *asDouble(3), *asDouble(4), *asDouble(5), *asDouble(6),
+                              *asDouble(7) != 0, *asDouble(8) != 0, *asDouble(9) != 0};
+
+            if (gridType == "regular_ll") {
+                return regularGridWindow(grid, north, west, south, east);
+            }
+
+            auto southPoleLat = asDouble(10), southPoleLon = asDouble(11);
+            if (southPoleLat && southPoleLon && asDouble(12).value_or(0) == 0) {
+                //The rows and columns covering the area in rotated coordinates, taken from points around its edge
+                double minLat = 90, maxLat = -90, minLon = 360, maxLon = -360;
+                const int steps = 64;
+                for (int step = 0; step <= steps; step++) {
+                    auto fraction = (double)step / steps;
+                    auto width = east >= west ? east - west : east + 360 - west;
+                    double edge[4][2] = {{north, west + fraction * width}, {south, west + fraction * width},
+                                         {south + fraction * (north - south), west}, {south + fraction * (north - south), east}};
+                    for (auto& point : edge) {
+                        double rotatedLat, rotatedLon;
+                        geographicToRotated(point[0], point[1], *southPoleLat, *southPoleLon, rotatedLat, rotatedLon);
+                        minLat = std::min(minLat, rotatedLat);
+                        maxLat = std::max(maxLat, rotatedLat);
+                        minLon = std::min(minLon, rotatedLon);
+                        maxLon = std::max(maxLon, rotatedLon);
+                    }
+                }
+                //A grid cell either side covers the curvature of the edges between the samples
+                auto window = regularGridWindow(grid, maxLat + grid.jIncrement, minLon - grid.iIncrement,
+                                                minLat - grid.jIncrement, maxLon + grid.iIncrement);
+                return filterByCoordinates(window, north, west, south, east);
+            }
+        }
+
+        //Any other grid is filtered using the coordinates of every point
+        std::vector<int> everyPoint(getNumberOfPoints());
+        std::iota(everyPoint.begin(), everyPoint.end(), 0);
+        return filterByCoordinates(everyPoint, north, west, south, east);
+    }
+
+    std::vector<int> GribMessage::filterByCoordinates(const std::vector<int>& indexes, double north, double west, double south, double east) {
+        auto coordinates = getCoordinates();
+        auto lats = castArray(coordinates.latitudes, arrow::float64());
+        auto lons = castArray(coordinates.longitudes, arrow::float64());
+        auto latValues = std::static_pointer_cast<arrow::DoubleArray>(lats)->raw_values();
+        auto lonValues = std::static_pointer_cast<arrow::DoubleArray>(lons)->raw_values();
+
+        auto width = east >= west ? east - west : east + 360 - west;
+        std::vector<int> selected;
+        for (auto index : indexes) {
+            auto lat = latValues[index];
+            auto offset = std::fmod(lonValues[index] - west, 360.0);
+            if (offset < 0) {
+                offset += 360.0;
+            }
+            if (lat >= south && lat <= north && (width >= 360 || offset <= width)) {
+                selected.push_back(index);
+            }
+        }
+        return selected;
+    }
+
+    std::shared_ptr<arrow::Table> GribMessage::getDataInArea(double north, double west, double south, double east) {
+
+        auto valueType = _reader->getValueType();
+        auto indexes = getAreaIndexes(north, west, south, east);
+        long count = indexes.size();
+
+        //Only the values of the points in the area are read
+        auto valuesBuffer = allocateBuffer(count, sizeof(double));
+        if (count > 0) {
+            readValuesAt(indexes.data(), count, (double*)valuesBuffer->mutable_data());
+        }
+        auto valuesArray = castArray(withMissingValues(std::make_shared<arrow::DoubleArray>(count, valuesBuffer)), valueType);
+
+        //The coordinates are taken from the cache of the grid
+        auto coordinates = getCoordinates();
+        auto indexesArray = std::make_shared<arrow::Int32Array>(count, arrow::Buffer::FromVector(std::move(indexes)));
+        auto lats = cp::Take(coordinates.latitudes, indexesArray);
+        auto lons = cp::Take(coordinates.longitudes, indexesArray);
+        if (!lats.ok() || !lons.ok()) {
+            throw ArrowGenericException("Unable to select the coordinates of the area " 
+                                        + (lats.ok() ? lons.status() : lats.status()).message());
+        }
+
+        std::vector<std::shared_ptr<arrow::Array>> columns {lats.ValueOrDie().make_array(), 
+                                                            lons.ValueOrDie().make_array(), 
+                                                            valuesArray};
+        return arrow::Table::Make(getDataSchema(valueType), columns, count);
+    }
+
+    std::shared_ptr<arrow::Array> GribMessage::getValues(long numberOfPoints) {
+
+        auto valueType = _reader->getValueType();
+        size_t valuesLength = numberOfPoints;
+        int err;
+        std::shared_ptr<arrow::Array> valuesArray;
+
+#if ECCODES_VERSION >= 23000
+        //eccodes can unpack straight to float so the values never exist as doubles
+        if (valueType->Equals(arrow::float32())) {
+            auto valuesBuffer = allocateBuffer(numberOfPoints, sizeof(float));
+            err = codes_get_float_array(h, "values", (float*)valuesBuffer->mutable_data(), &valuesLength);
+            valuesArray = std::make_shared<arrow::FloatArray>(numberOfPoints, valuesBuffer);
+        } else
+#endif
+        {
+            auto valuesBuffer = allocateBuffer(numberOfPoints, sizeof(double));
+            err = codes_get_double_array(h, "values", (double*)valuesBuffer->mutable_data(), &valuesLength);
+            valuesArray = std::make_shared<arrow::DoubleArray>(numberOfPoints, valuesBuffer);
+        }
+
+        if (err != 0) {
+            std::ostringstream oss;
+            oss << "Error unpacking the values got error code " << err
+             << " whilst processing message id " << _message_id
+             << " whilst processing file " << _reader->getFilePath();
+
+            throw CodesGetDoubleValuesAsArrayException (oss.str());
+        }
+
+        return castArray(withMissingValues(valuesArray), valueType);
+    }
+
+    std::shared_ptr<arrow::Array> GribMessage::withMissingValues(std::shared_ptr<arrow::Array> valuesArray) {
+
+        //Without a bitmap every point has a value even if it happens to equal missingValue
+        if (metadata.bitmapPresent.value_or(0) != 1) {
+            return valuesArray;
+        }
+
+        auto missingValue = metadata.missingValue.value_or(9999);
+        auto result = missingToNull(valuesArray, missingValue);
+        if (!result.ok()) {
+            throw ArrowGenericException("Unable to mark missing values as null " + result.status().message());
+        }
+        return result.ValueOrDie();
+    }
+
     GribMessage::~GribMessage() {
         //printf("Destuctor called on handle %p\n", h);
         //codes_grib_nearest_delete()
@@ -354,54 +675,65 @@ using namespace std;
 
     std::variant<long, std::string, double, nullptr_t> GribMessage::tryGetKey(string parameterName) {
 
-        auto dblDefault = std::nan("");
-        long maxLong {std::numeric_limits<long>::max()};
-        auto stringDefault = "InTheBlueRidgeMountainsOfViriginaOnTheTrailOfTheLonesomePine";
-
-        std::cout << "Getting key " << parameterName << std::endl;
+        auto value = readKeys({parameterName})[0];
 
-        
-        auto longResult = getNumericParameterOrDefault(parameterName, maxLong);
-        if (longResult != maxLong) {
-            //we got a result but it's possibly a string
-            if (longResult == 0) {
-                auto stringResult = getStringParameterOrDefault(parameterName, stringDefault);
-                std::cout << "Value of string is " << stringResult << std::endl;
-                if(stringResult == stringDefault) {
-                    std::cout << "returning long" << longResult << std::endl;
-                    return {longResult};
-                } 
-                return {stringResult};
-            }
-            return {longResult};
-        }
-
-        //it wasn't a double or the key doesn't exist
-        auto doubleResult = getDoubleParameterOrDefault(parameterName, dblDefault);
-        if (!std::isnan(doubleResult)) {
-            std::cout << "Value of double is " << doubleResult << std::endl;
-            //its not a double but it might be a string key
-            auto stringResult = getStringParameterOrDefault(parameterName, stringDefault);
-            std::cout << "Value of string is " << stringResult << std::endl;
-            if(stringResult == stringDefault) {
-                std::cout << "returning double" << doubleResult << std::endl;
-                return {doubleResult};
-            } 
-            std::cout << "returning string" << stringResult << std::endl;
-            return {stringResult};
+        if (auto longValue = std::get_if<long>(&value)) {
+            return {*longValue};
+        }
+        if (auto doubleValue = std::get_if<double>(&value)) {
+            return {*doubleValue};
+        }
+        if (auto stringValue = std::get_if<std::string>(&value)) {
+            return {*stringValue};
         }
+        return {nullptr};
+    }
 
+    std::string GribMessage::getKeyDefinition() {
+        //Key types depend on the templates used by the message
+        std::ostringstream oss;
+        oss << metadata.editionNumber.value_or(-1) << ":" 
+            << metadata.gridDefinitionTemplateNumber.value_or(-1) << ":"
+            << metadata.productDefinitionTemplateNumber.value_or(-1);
+        return oss.str();
+    }
 
-        auto stringResult = getStringParameterOrDefault(parameterName, stringDefault);
-        if (stringResult != stringDefault) {
-            std::cout << "its a string " << std::endl;
-            return {stringResult};
+    std::vector<KeyValue> GribMessage::readKeys(const std::vector<std::string>& keys) {
+
+        auto definition = getKeyDefinition();
+        auto& keyTypes = _reader->getKeyTypeCache();
+
+        std::vector<KeyValue> values;
+        values.reserve(keys.size());
+        for (auto& key : keys) {
+            auto nativeType = keyTypes.find(definition, key);
+            if (!nativeType.has_value()) {
+                nativeType = getNativeKeyType(h, key);
+                //A missing key isn't cached as it might be present in the next message
+                if (nativeType.value() != CODES_TYPE_UNDEFINED) {
+                    keyTypes.add(definition, key, nativeType.value());
+                }
+            }
+            values.push_back(readKey(h, key, nativeType.value()));
         }
+        return values;
+    }
 
+    std::shared_ptr<arrow::RecordBatch> GribMessage::getKeys(std::vector<std::string> keys) {
 
-        std::cout << "No result found for key " << parameterName << std::endl;
-        return {nullptr};
+        auto values = readKeys(keys);
 
+        arrow::FieldVector fields;
+        arrow::ArrayVector columns;
+        for (size_t i = 0; i < keys.size(); i++) {
+            auto column = keyValuesToArrow({values[i]});
+            if (!column.ok()) {
+                throw ArrowGenericException("Unable to create column for key " + keys[i] + " " + column.status().message());
+            }
+            fields.push_back(arrow::field(keys[i], column.ValueOrDie()->type()));
+            columns.push_back(column.ValueOrDie());
+        }
+        return arrow::RecordBatch::Make(arrow::schema(fields), 1, columns);
     }
 
     double GribMessage::getDoubleParameter(string parameterName) {
@@ -434,209 +766,481 @@ using namespace std;
         auto iDirection = iScansNegatively();
         auto jDirection = jScansPositively();
         auto numPoints = getNumberOfPoints();
+        //The corners don't distinguish every grid (eg rotated or projected grids) so the rest of the definition is included
+        auto gridDefinition = readKey(h, "md5GridSection");
+        auto definition = std::holds_alternative<std::string>(gridDefinition) ? std::get<std::string>(gridDefinition) : "";
+
+        return std::unique_ptr<GridArea>  (new GridArea(lat1, lon1, lat2, lon2, iDirection, jDirection, numPoints, definition));
+    }
+
+    std::shared_ptr<GribLocationData> GribMessage::getLocationData(std::unique_ptr<GridArea>& gridArea) {
+
+        //Only one thread searches for the nearest points of a new area, the others wait for it outside the caches' locks
+        return _reader->getOrSearchLocationData(gridArea, [this, &gridArea]() {
+            //The corners of a projected grid don't bound it so its locations are filtered using the projection
+            auto projection = getProjection();
+            auto selection = _reader->selectLocations(gridArea, 
+                                                      projection && !projection->followsMeridians() ? projection.get() : nullptr);
+            //Only the columns used to match the locations are copied for the grid, the others are gathered when asked for
+            auto locations_shared = _reader->getLocations();
+            std::vector<std::shared_ptr<arrow::Field>> keyFields;
+            std::vector<std::shared_ptr<arrow::Array>> keyColumns;
+            for (auto name : {"lat", "lon", "surrogate_key"}) {
+                keyFields.push_back(locations_shared->schema()->GetFieldByName(name));
+                keyColumns.push_back(GribLocationData::gatherColumn(locations_shared->GetColumnByName(name), selection));
+            }
+            auto locations = arrow::RecordBatch::Make(arrow::schema(keyFields), 
+                                                      selection ? selection->length() : locations_shared->num_rows(), 
+                                                      keyColumns);
+
+            //The coordinates are read straight from the arrow buffers
+            auto latsArray = std::static_pointer_cast<arrow::DoubleArray>(locations->GetColumnByName("lat"));
+            auto lonsArray = std::static_pointer_cast<arrow::DoubleArray>(locations->GetColumnByName("lon"));
+            const double* inlats = latsArray->raw_values();
+            const double* inlons = lonsArray->raw_values();
+
+            long numberOfPoints = locations->num_rows();
+
+            //Another reader may already have matched these locations to this grid
+            auto store = _reader->getLocationStore();
+            std::string storeKey;
+            std::optional<StoredLocationData> matched;
+            if (store) {
+                storeKey = getLocationStoreKey(*gridArea, inlats, inlons, numberOfPoints);
+                matched = store->load(storeKey, numberOfPoints, getNumberOfPoints());
+            }
+            if (!matched.has_value()) {
+                matched = matchLocations(inlats, inlons, numberOfPoints, projection.get());
+                if (store) {
+                    store->save(storeKey, numberOfPoints, matched.value());
+                }
+            }
+
+            auto valueType = _reader->getValueType();
+            auto distanceArray = castArray(matched->distances, valueType);
+            auto outlatsArray = castArray(matched->outlats, valueType);
+            auto outlonsArray = castArray(matched->outlons, valueType);
 
-        return std::unique_ptr<GridArea>  (new GridArea(lat1, lon1, lat2, lon2, iDirection, jDirection, numPoints));
+            auto cache_data = std::make_shared<GribLocationData>(numberOfPoints, 
+                                                    matched->indexes,
+                                                    latsArray,
+                                                    lonsArray,
+                                                    distanceArray,
+                                                    outlatsArray,
+                                                    outlonsArray,
+                                                    locations,
+                                                    locations_shared,
+                                                    selection,
+                                                    matched->interpolationWeights);
+
+            printf("set values in cache with numberOfPoints = %ld", numberOfPoints);
+
+            return cache_data;
+        });
     }
 
-    std::vector<double> GribMessage::colToVector(std::shared_ptr<arrow::ChunkedArray> columnArray) {
-        std::vector<double> double_vector;
-        auto array = columnArray.get();
-        for(int i=0; i < array->num_chunks(); i++) {
-            auto chunk = array->chunk(i);
-            auto arrow_double_array = std::static_pointer_cast<arrow::DoubleArray>(chunk);
 
-            for (int64_t j = 0; j < array->length(); ++j) 
-            {
-                double_vector.push_back(arrow_double_array->Value(j));
+    StoredLocationData GribMessage::matchLocations(const double* inlats, const double* inlons, long numberOfPoints,
+                                                   const GridProjection* projection) {
+        auto outlatsBuffer = allocateBuffer(numberOfPoints, sizeof(double));
+        auto outlonsBuffer = allocateBuffer(numberOfPoints, sizeof(double));
+        auto distancesBuffer = allocateBuffer(numberOfPoints, sizeof(double));
+        auto indexesBuffer = allocateBuffer(numberOfPoints, sizeof(int));
+
+        auto outlats = (double*)outlatsBuffer->mutable_data();
+        auto outlons = (double*)outlonsBuffer->mutable_data();
+        auto distances = (double*)distancesBuffer->mutable_data();
+        auto indexes = (int*)indexesBuffer->mutable_data();
+
+        //Grids without a supported projection use eccodes
+        auto nearestMethod = _reader->getNearestMethod();
+        if (nearestMethod == NearestMethod::Projection && !projection) {
+            nearestMethod = NearestMethod::Eccodes;
+        }
+
+        //The coordinates of the grid are only read when a kd-tree or the projection needs them
+        auto interpolationMethod = _reader->getInterpolationMethod();
+        std::vector<double> gridLats;
+        std::vector<double> gridLons;
+        std::unique_ptr<KdTree> tree;
+        if (nearestMethod != NearestMethod::Eccodes || interpolationMethod == InterpolationMethod::InverseDistance) {
+            getGridCoordinates(gridLats, gridLons);
+        }
+        if (nearestMethod == NearestMethod::KdTree || interpolationMethod == InterpolationMethod::InverseDistance) {
+            tree = std::make_unique<KdTree>(gridLats.data(), gridLons.data(), gridLats.size());
+        }
+
+        //Projected grids are always interpolated within the cells of the projection, eccodes only finds cells on regular grids
+        bool usesProjection = nearestMethod == NearestMethod::Projection || (projection && !projection->followsMeridians());
+
+        //The locations are matched in blocks so the memory used by eccodes and the interpolation
+        //doesn't grow with the number of locations
+        std::shared_ptr<InterpolationWeights> interpolationWeights;
+        for (long first = 0; first < numberOfPoints; first += LOCATION_BLOCK_SIZE) {
+            long count = std::min(LOCATION_BLOCK_SIZE, numberOfPoints - first);
+
+            if (nearestMethod == NearestMethod::KdTree) {
+                findNearestWithKdTree(*tree, gridLats, gridLons, inlats + first, inlons + first, count,
+                                      outlats + first, outlons + first, distances + first, indexes + first);
+            } else if (nearestMethod == NearestMethod::Projection) {
+                findNearestWithProjection(*projection, gridLats, gridLons, inlats + first, inlons + first, count,
+                                          outlats + first, outlons + first, distances + first, indexes + first);
+            } else {
+                std::vector<double> outvalues(count);
+                grib_nearest_find_multiple(h,1, inlats + first, inlons + first, count, 
+                                        outlats + first, 
+                                        outlons + first, 
+                                        outvalues.data(), 
+                                        distances + first, 
+                                        indexes + first);
             }
+
+            auto blockWeights = getInterpolationWeights(inlats + first, inlons + first, count, tree.get(), 
+                                                        usesProjection ? projection : nullptr);
+            if (!blockWeights) {
+                continue;
+            }
+            if (!interpolationWeights) {
+                interpolationWeights = std::make_shared<InterpolationWeights>();
+                interpolationWeights->stencilSize = blockWeights->stencilSize;
+                interpolationWeights->indexes.reserve(numberOfPoints * blockWeights->stencilSize);
+                interpolationWeights->weights.reserve(numberOfPoints * blockWeights->stencilSize);
+            }
+            interpolationWeights->indexes.insert(interpolationWeights->indexes.end(), blockWeights->indexes.begin(), blockWeights->indexes.end());
+            interpolationWeights->weights.insert(interpolationWeights->weights.end(), blockWeights->weights.begin(), blockWeights->weights.end());
         }
-        return double_vector;
 
+        return StoredLocationData {indexesBuffer,
+                                   std::make_shared<arrow::DoubleArray>(numberOfPoints, distancesBuffer),
+                                   std::make_shared<arrow::DoubleArray>(numberOfPoints, outlatsBuffer),
+                                   std::make_shared<arrow::DoubleArray>(numberOfPoints, outlonsBuffer),
+                                   interpolationWeights};
     }
 
-    GribLocationData* GribMessage::getLocationData(std::unique_ptr<GridArea> gridArea) {
+    std::string GribMessage::getLocationStoreKey(const GridArea& gridArea, const double* inlats, const double* inlons, long numberOfPoints) {
+        StableHash key;
 
-        auto cache_results = _reader->getLocationDataFromCache(gridArea);
+        //The grid area includes md5GridSection so covers the whole grid definition
+        key.add((int64_t)gridArea.stableHash());
 
-        if(cache_results.has_value()) {
-            return cache_results.value();
-        } 
-        else {
-            auto locations_shared = _reader->getLocations(gridArea);
-            auto locations = locations_shared.get();
-            //Ok we have an arrow table - get the pointers
-            auto lats = locations->GetColumnByName("lat");
-            auto lats_vector = colToVector(lats);
-            auto lons = locations->GetColumnByName("lon");
-            auto lons_vector = colToVector(lons);
-
-            double* inlats = &lats_vector[0];
-            double* inlons = &lons_vector[0];
-
-            long numberOfPoints = lats_vector.size();
-            double *outlats, *outlons, *outvalues, *distances;
-            int *indexes; /* arrays */
-
-            outlats = (double*)malloc(numberOfPoints * sizeof(double));
-            if (!outlats) {
-                auto numBytes = (long)(numberOfPoints * sizeof(double));
-                        std::ostringstream oss;
-                            oss << "Error: unable to allocate " << numBytes << " bytes";
-    
-                    throw MemoryAllocationException(oss.str());
+        //How the locations were matched
+        key.add((int64_t)_reader->getNearestMethod())
+           .add((int64_t)_reader->getInterpolationMethod())
+           .add((int64_t)_reader->getInterpolationNeighbours());
+
+        key.add((int64_t)numberOfPoints)
+           .add(inlats, numberOfPoints * sizeof(double))
+           .add(inlons, numberOfPoints * sizeof(double));
+        return key.toString();
+    }
+
+    void GribMessage::getGridCoordinates(std::vector<double>& lats, std::vector<double>& lons) {
+        auto numberOfPoints = getNumberOfPoints();
+        lats.resize(numberOfPoints);
+        lons.resize(numberOfPoints);
+        std::vector<double> values(numberOfPoints);
+
+        auto err = codes_grib_get_data(h, lats.data(), lons.data(), values.data());
+        if (err != 0) {
+            std::ostringstream oss;
+            oss << "Error calling codes_grib_get_data got error code " << err
+             << " whilst processing message id " << _message_id
+             << " whilst processing file " << _reader->getFilePath();
+
+            throw GribException (oss.str());
+        }
+    }
+
+    void GribMessage::findNearestWithKdTree(const KdTree& tree, const std::vector<double>& gridLats, const std::vector<double>& gridLons,
+                                            const double* inlats, const double* inlons, long numberOfPoints,
+                                            double* outlats, double* outlons, double* distances, int* indexes) {
+        //The tree is only built when the nearest points of a new grid are needed, the result is cached per grid
+        tree.nearest(inlats, inlons, numberOfPoints, _reader->getWorkerThreads(), indexes, distances);
+
+        for (long i = 0; i < numberOfPoints; i++) {
+            outlats[i] = gridLats[indexes[i]];
+            outlons[i] = gridLons[indexes[i]];
+        }
+    }
+
+    void GribMessage::findNearestWithProjection(const GridProjection& projection, const std::vector<double>& gridLats, 
+                                                const std::vector<double>& gridLons, const double* inlats, const double* inlons, 
+                                                long numberOfPoints, double* outlats, double* outlons, double* distances, int* indexes) {
+        //The nearest point is one of the corners of the grid cell around the location
+        int corners[4];
+        double weights[4];
+        for (long i = 0; i < numberOfPoints; i++) {
+            projection.surroundingPoints(inlats[i], inlons[i], corners, weights);
+            indexes[i] = corners[0];
+            distances[i] = greatCircleDistance(inlats[i], inlons[i], gridLats[corners[0]], gridLons[corners[0]]);
+            for (int n = 1; n < 4; n++) {
+                auto distance = greatCircleDistance(inlats[i], inlons[i], gridLats[corners[n]], gridLons[corners[n]]);
+                if (distance < distances[i]) {
+                    indexes[i] = corners[n];
+                    distances[i] = distance;
+                }
             }
-            outlons = (double*)malloc(numberOfPoints * sizeof(double));
-            if (!outlons) {
-                auto numBytes = (long)(numberOfPoints * sizeof(double));
-                        std::ostringstream oss;
-                            oss << "Error: unable to allocate " << numBytes << " bytes";
-    
-                    throw MemoryAllocationException(oss.str());
-                free(outlats);
-            }
-            outvalues = (double*)malloc(numberOfPoints * sizeof(double));
-            if (!outvalues) {
-                auto numBytes = (long)(numberOfPoints * sizeof(double));
-                        std::ostringstream oss;
-                            oss << "Error: unable to allocate " << numBytes << " bytes";
-    
-                    throw MemoryAllocationException(oss.str());
-                free(outlats);
-                free(outlons);
-            }
-            distances = (double*)malloc(numberOfPoints * sizeof(double));
-            if (!distances) {
-                auto numBytes = (long)(numberOfPoints * sizeof(double));
-                        std::ostringstream oss;
-                            oss << "Error: unable to allocate " << numBytes << " bytes";
-    
-                    throw MemoryAllocationException(oss.str());
-                free(outlats);
-                free(outlons);
-                free(outvalues);
-            }
-            indexes = (int*)malloc(numberOfPoints * sizeof(int));
-            if (!indexes) {
-                auto numBytes = (long)(numberOfPoints * sizeof(double));
-                        std::ostringstream oss;
-                            oss << "Error: unable to allocate " << numBytes << " bytes";
-    
-                    throw MemoryAllocationException(oss.str());
-                free(outlats);
-                free(outlons);
-                free(outvalues);
-                free(distances);
+            outlats[i] = gridLats[indexes[i]];
+            outlons[i] = gridLons[indexes[i]];
+        }
+    }
+
+    std::shared_ptr<GridProjection> GribMessage::getProjection() {
+        auto keys = readKeys({"gridType", "Ni", "Nj", "Nx", "Ny",
+                              "latitudeOfFirstGridPointInDegrees", "longitudeOfFirstGridPointInDegrees",
+                              "iDirectionIncrementInDegrees", "jDirectionIncrementInDegrees",
+                              "iScansNegatively", "jScansPositively", "jPointsAreConsecutive",
+                              "latitudeOfSouthernPoleInDegrees", "longitudeOfSouthernPoleInDegrees", "angleOfRotationInDegrees",
+                              "Latin1InDegrees", "Latin2InDegrees", "LoVInDegrees", "DxInMetres", "DyInMetres",
+                              "earthIsOblate", "radius"});
+        auto asDouble = [&keys](size_t k) { return keyAsDouble(keys[k]); };
+        auto has = [&asDouble](std::initializer_list<size_t> ks) {
+            return std::all_of(ks.begin(), ks.end(), [&asDouble](size_t k) { return asDouble(k).has_value(); });
+        };
+        auto gridType = std::holds_alternative<std::string>(keys[0]) ? std::get<std::string>(keys[0]) : "";
+
+        if ((gridType == "regular_ll" || gridType == "rotated_ll") && has({1, 2, 5, 6, 7, 8, 9, 10, 11})) {
+            RegularGrid grid {(long)*asDouble(1), (long)*asDouble(2), *asDouble(5), *asDouble(6), *asDouble(7), *asDouble(8),
+                              *asDouble(9) != 0, *asDouble(10) != 0, *asDouble(11) != 0};
+            if (gridType == "regular_ll") {
+                return std::make_shared<LatLonProjection>(grid);
             }
+            if (has({12, 13}) && asDouble(14).value_or(0) == 0) {
+                return std::make_shared<LatLonProjection>(grid, *asDouble(12), *asDouble(13));
+            }
+        }
 
-             
-            
+        //Only a spherical earth is supported, an oblate earth is left to eccodes
+        if (gridType == "lambert" && has({3, 4, 5, 6, 9, 10, 11, 15, 16, 17, 18, 19, 21}) && asDouble(20).value_or(0) == 0) {
+            return std::make_shared<LambertConformalProjection>((long)*asDouble(3), (long)*asDouble(4), *asDouble(5), *asDouble(6),
+                                                                *asDouble(15), *asDouble(16), *asDouble(17), 
+                                                                *asDouble(18), *asDouble(19),
+                                                                *asDouble(9) != 0, *asDouble(10) != 0, *asDouble(11) != 0,
+                                                                *asDouble(21));
+        }
+        return nullptr;
+    }
 
-            grib_nearest_find_multiple(h,1, inlats, inlons, 
-                                    numberOfPoints, outlats, outlons, outvalues, distances, indexes);
+    std::shared_ptr<InterpolationWeights> GribMessage::getInterpolationWeights(const double* inlats, const double* inlons,
+                                                                               long numberOfPoints, const KdTree* tree,
+                                                                               const GridProjection* projection) {
+        auto method = _reader->getInterpolationMethod();
+        if (method == InterpolationMethod::Nearest) {
+            return nullptr;
+        }
 
-            //std::cout << "status of grib_find_nearest_multiple is " << status << std::endl;
+        auto weights = std::make_shared<InterpolationWeights>();
+
+        if (method == InterpolationMethod::InverseDistance) {
+            size_t k = _reader->getInterpolationNeighbours();
+            weights->stencilSize = k;
+            weights->indexes.resize(numberOfPoints * k);
+            weights->weights.resize(numberOfPoints * k);
+            std::vector<double> distances(numberOfPoints * k);
+            tree->nearest(inlats, inlons, numberOfPoints, _reader->getWorkerThreads(),
+                          weights->indexes.data(), distances.data(), k);
+
+            for (long i = 0; i < numberOfPoints; i++) {
+                auto indexes = &weights->indexes[i * k];
+                inverseDistanceWeights(&distances[i * k], k, &weights->weights[i * k]);
+                //A grid with fewer than k points pads the stencil, the padding has no weight but must be a valid index
+                for (size_t n = 1; n < k; n++) {
+                    if (indexes[n] < 0) {
+                        indexes[n] = indexes[0];
+                    }
+                }
+            }
+            return weights;
+        }
 
-            auto latsArray = doubleFieldToArrow(numberOfPoints, inlats, false);
-            auto lonsArray = doubleFieldToArrow(numberOfPoints, inlons, false);
-            auto outvaluesArray = doubleFieldToArrow(numberOfPoints, outvalues, true);
-            auto distanceArray = doubleFieldToArrow(numberOfPoints, distances, false);
-            auto outlatsArray = doubleFieldToArrow(numberOfPoints, outlats, false);
-            auto outlonsArray = doubleFieldToArrow(numberOfPoints, outlons, false);
+        //eccodes returns the 4 points surrounding a location which are two points on each of two rows for regular and reduced grids
+        const size_t stencilSize = 4;
+        weights->stencilSize = stencilSize;
+        weights->indexes.resize(numberOfPoints * stencilSize);
+        weights->weights.resize(numberOfPoints * stencilSize, 0.0);
 
-            auto cache_data = new GribLocationData(numberOfPoints, 
-                                                    indexes,
-                                                    latsArray,
-                                                    lonsArray,
-                                                    distanceArray,
-                                                    outlatsArray,
-                                                    outlonsArray,
-                                                    locations_shared.get()->CombineChunksToBatch().ValueOrDie());
+        //The rows of a projected grid don't follow the parallels so the corners of the grid cell are used instead
+        if (projection) {
+            for (long i = 0; i < numberOfPoints; i++) {
+                projection->surroundingPoints(inlats[i], inlons[i], &weights->indexes[i * stencilSize], &weights->weights[i * stencilSize]);
+            }
+            return weights;
+        }
 
-            auto result = _reader->addLocationDataToCache(gridArea, cache_data);
+        int err = 0;
+        auto nearest = codes_grib_nearest_new(h, &err);
+        if (err != 0) {
+            std::ostringstream oss;
+            oss << "Error calling codes_grib_nearest_new got error code " << err
+             << " whilst processing message id " << _message_id
+             << " whilst processing file " << _reader->getFilePath();
 
-            printf("set values in cache with numberOfPoints = %ld", numberOfPoints);
+            throw GribException (oss.str());
+        }
 
-            return result;
+        double outlats[stencilSize], outlons[stencilSize], outvalues[stencilSize], distances[stencilSize];
+        for (long i = 0; i < numberOfPoints; i++) {
+            size_t count = stencilSize;
+            auto indexes = &weights->indexes[i * stencilSize];
+            err = codes_grib_nearest_find(nearest, h, inlats[i], inlons[i], CODES_NEAREST_SAME_GRID | CODES_NEAREST_SAME_DATA,
+                                          outlats, outlons, outvalues, distances, indexes, &count);
+            if (err != 0) {
+                codes_grib_nearest_delete(nearest);
+                std::ostringstream oss;
+                oss << "Error calling codes_grib_nearest_find got error code " << err
+                 << " for the location " << inlats[i] << ", " << inlons[i]
+                 << " whilst processing message id " << _message_id
+                 << " whilst processing file " << _reader->getFilePath();
+
+                throw GribException (oss.str());
+            }
 
+            bilinearWeights(inlats[i], inlons[i], outlats, outlons, distances, count, &weights->weights[i * stencilSize]);
+            for (size_t n = count; n < stencilSize; n++) {
+                indexes[n] = indexes[0];
+            }
         }
+        codes_grib_nearest_delete(nearest);
+        return weights;
     }
 
+    void GribMessage::readValuesAt(const int* indexes, long count, double* values) {
+        auto start = std::chrono::steady_clock::now();
+        auto numberOfPoints = getNumberOfPoints();
+        auto packingType = readKey(h, "packingType");
+        auto packing = std::holds_alternative<std::string>(packingType) ? std::get<std::string>(packingType) : "";
 
-   std::shared_ptr<arrow::Table> GribMessage::getDataWithLocations() {
+        auto method = _reader->getValueExtraction();
+        if (method == ValueExtraction::Auto) {
+            method = chooseValueExtraction(packing, count, numberOfPoints);
+        }
 
-        if (_reader->hasLocations()) {
+        int ret_code;
+        if (method == ValueExtraction::FullDecode) {
+            //The reader lends a buffer so the field isn't reallocated for every message, it goes back after the gather
+            auto decoded = _reader->acquireDecodeBuffer(numberOfPoints);
+            size_t size = numberOfPoints;
+            ret_code = codes_get_double_array(h, "values", decoded->data(), &size);
+            if (ret_code == 0) {
+                gatherValues(decoded->data(), indexes, count, values);
+            }
+        } else {
+            ret_code = codes_get_double_elements(h, "values", indexes, count, values);
+        }
+        if (ret_code != 0) {
+            std::ostringstream oss;
+            oss << "Error calling " << (method == ValueExtraction::FullDecode ? "codes_get_double_array" : "codes_get_double_elements")
+             << " got error code " << ret_code
+             << " whilst processing message id " << _message_id
+             << " whilst processing file " << _reader->getFilePath();
 
-            auto gridArea = getGridArea();
+            throw CodesGetDoubleValuesAsArrayException (oss.str());
+        }
 
-            auto location_data = getLocationData(std::move(gridArea));
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        extractionStats = ExtractionStats {method, packing, count, numberOfPoints, elapsed.count()};
+    }
 
-            long numberOfPoints = location_data->numberOfPoints;
-            auto indexes = location_data->indexes.get();
-            double *doubleValues;
-
-            doubleValues = (double*)malloc(numberOfPoints * sizeof(double));
-            if (doubleValues != 0) {
-                auto numBytes = (long)(numberOfPoints * sizeof(double));
-                       std::ostringstream oss;
-                        oss << "Error: unable to allocate " << numBytes << " bytes";
- 
-                throw MemoryAllocationException(oss.str());
+    std::optional<ExtractionStats> GribMessage::getExtractionStats() {
+        return extractionStats;
+    }
+
+   std::shared_ptr<arrow::Array> GribMessage::getValuesAtLocations(std::shared_ptr<GribLocationData> location_data) {
+
+        long numberOfPoints = location_data->numberOfPoints;
+        auto indexes = (const int*)location_data->indexes->data();
 
+        auto valuesBuffer = allocateBuffer(numberOfPoints, sizeof(double));
+        auto doubleValues = (double*)valuesBuffer->mutable_data();
+
+        auto weights = location_data->interpolationWeights;
+        if (weights) {
+            //Only the points of the stencils are read, the weights were calculated when the grid was first seen
+            std::vector<double> stencilValues(weights->indexes.size());
+            readValuesAt(weights->indexes.data(), weights->indexes.size(), stencilValues.data());
+            std::optional<double> missingValue;
+            if (metadata.bitmapPresent.value_or(0)) {
+                missingValue = metadata.missingValue.value_or(9999);
             }
+            applyWeights(*weights, stencilValues.data(), numberOfPoints, missingValue, doubleValues);
+        } else {
+            readValuesAt(indexes, numberOfPoints, doubleValues);
+        }
 
-            auto ret_code = codes_get_double_elements(h, "values", indexes, numberOfPoints, doubleValues);
+        //Only the values at the locations are narrowed
+        arrow::Result<std::shared_ptr<arrow::Array>> valuesArray = castArray(
+            withMissingValues(std::make_shared<arrow::DoubleArray>(numberOfPoints, valuesBuffer)), _reader->getValueType());
 
-            auto valuesArray = doubleFieldToArrow(numberOfPoints, doubleValues, true);
+        //apply any conversions
+        auto parameterId = getParameterId();
+        auto conversionFunc = _reader->getConversions(parameterId);
 
-            //apply any conversions
-            auto parameterId = getParameterId();
-            auto conversionFunc = _reader->getConversions(parameterId);
+        if(conversionFunc.has_value()) {
+            auto func = conversionFunc.value();
+            valuesArray = func(valuesArray.ValueOrDie());
+        }
 
-            if(conversionFunc.has_value()) {
-                auto func = conversionFunc.value();
-                valuesArray = func(valuesArray.ValueOrDie());
-            }
+        return valuesArray.ValueOrDie();
+    }
+
+   std::shared_ptr<arrow::Table> GribMessage::getDataWithLocations(std::vector<std::string> columns) {
 
-            //Add all the fields from our lookup table first
-            arrow::FieldVector fields;
-            
-            auto locationFieldsVector = location_data->tableData.get()->schema().get()->fields();
-            for(auto f : locationFieldsVector) {
-                auto field = f.get();
-                fields.push_back(arrow::field(field->name(), field->type()));
+        if (columns.empty()) {
+            columns = _reader->getColumns();
+        }
+
+        if (prefetchedLocationData) {
+            if (columns.empty()) {
+                return prefetchedLocationData;
             }
-        
-            fields.push_back(arrow::field("parameterId", arrow::int32()));
-            fields.push_back(arrow::field("modelNo", arrow::uint8()));
-            fields.push_back(arrow::field("forecast_date", arrow::timestamp(arrow::TimeUnit::SECOND)));
-            fields.push_back(arrow::field("datetime", arrow::timestamp(arrow::TimeUnit::SECOND)));
-            //Now add the data from the lookups and grib data.
-            fields.push_back(arrow::field("distance", arrow::float64()));
-            fields.push_back(arrow::field("nearestlatitude", arrow::float64()));
-            fields.push_back(arrow::field("nearestlongitude", arrow::float64()));
-            fields.push_back(arrow::field("value", arrow::float64()));
+            if (auto prefetched = selectPrefetched(prefetchedLocationData, columns)) {
+                return prefetched;
+            }
+        }
 
-            auto schema = arrow::schema(fields);
+        if (_reader->hasLocations()) {
+
+            auto gridArea = getGridArea();
+
+            auto location_data = getLocationData(gridArea);
+
+            long numberOfPoints = location_data->numberOfPoints;
+            auto fields = selectFields(getDataWithLocationsSchema(_reader->getLocationSchema(), 
+                                                                _reader->getValueType(), 
+                                                                _reader->getConstantColumnEncoding()), columns);
 
+            //Only the columns which were asked for are built
             std::vector<std::shared_ptr<arrow::Array>> resultsArray;
+            bool gathered = false;
+            for (auto& field : fields) {
+                auto name = field->name();
+                if (auto locationColumn = location_data->getLocationColumn(name, &gathered)) {
+                    resultsArray.push_back(locationColumn);
+                } else if (name == "distance") {
+                    resultsArray.push_back(location_data->distanceArray.ValueOrDie());
+                } else if (name == "nearestlatitude") {
+                    resultsArray.push_back(location_data->outlatsArray.ValueOrDie());
+                } else if (name == "nearestlongitude") {
+                    resultsArray.push_back(location_data->outlonsArray.ValueOrDie());
+                } else if (name == "value") {
+                    resultsArray.push_back(getValuesAtLocations(location_data));
+                } else {
+                    resultsArray.push_back(getMessageColumn(name, numberOfPoints));
+                }
+            }
 
-            
-            for (auto column : location_data->tableData.get()->columns()) {
-                resultsArray.push_back(column);
+            //The columns gathered for the grid count towards the size of the location cache
+            if (gathered) {
+                _reader->resizeLocationDataInCache(gridArea, location_data);
             }
 
-            resultsArray.push_back(fieldToArrow(numberOfPoints, (u_int32_t)parameterId).ValueOrDie());
-            resultsArray.push_back(fieldToArrow(numberOfPoints, (u_int8_t) getModelNumber()).ValueOrDie());
-            resultsArray.push_back(fieldToArrow(numberOfPoints, getChronoDate()).ValueOrDie());
-            resultsArray.push_back(fieldToArrow(numberOfPoints, getObsDate()).ValueOrDie());
-            resultsArray.push_back(location_data->distanceArray.ValueOrDie());
-            resultsArray.push_back(location_data->outlatsArray.ValueOrDie());
-            resultsArray.push_back(location_data->outlonsArray.ValueOrDie());
-            resultsArray.push_back(valuesArray.ValueOrDie());
+            auto schema = arrow::schema(fields);
 
             auto table = arrow::Table::Make(schema, resultsArray, numberOfPoints);
 
             return table;
 
         }
+
+        throw InvalidSchemaException("getDataWithLocations requires withLocations to be called on the reader");
     }
@@ -13,6 +13,16 @@
 #include "eccodes.h"
 #include "gribreader.hpp"
 #include "caster.hpp"
+#include "arrowutils.hpp"
+#include "messagemetadata.hpp"
+#include "keyvalues.hpp"
+#include "kdtree.hpp"
+#include "interpolation.hpp"
+#include "valueextraction.hpp"
+#include "locationstore.hpp"
+#include "subgrid.hpp"
+#include "projection.hpp"
+#include "gridcoordinates.hpp"
 
 
 using namespace std;
@@ -73,9 +83,35 @@ class GribMessage
         //template <typename T> 
         //T tryGetKey(string parameterName);
         std::variant<long, std::string, double, nullptr_t> tryGetKey(string parameterName);
-
-        std::shared_ptr<arrow::Table> getData();
-        std::shared_ptr<arrow::Table> getDataWithLocations();
+        //Reads each key once using its native type, the type is only looked up for the first message with the
+        //same grid and product definition. A key the message doesn't have is empty (std::monostate)
+        std::vector<KeyValue> readKeys(const std::vector<std::string>& keys);
+        //As readKeys as a single row with a typed column per key
+        std::shared_ptr<arrow::RecordBatch> getKeys(std::vector<std::string> keys);
+
+        //columns restricts the result to the named columns, when empty the columns given to the reader
+        //by withColumns are used and if there are none every column is returned
+        std::shared_ptr<arrow::Table> getData(std::vector<std::string> columns = {});
+        std::shared_ptr<arrow::Table> getDataWithLocations(std::vector<std::string> columns = {});
+        //The points between the latitudes north and south and the longitudes west and east (going east)
+        //Only the values of those points are read, the coordinates come from the cache of the grid
+        std::shared_ptr<arrow::Table> getDataInArea(double north, double west, double south, double east);
+        //How the values at the locations were read, empty until getDataWithLocations has read them
+        std::optional<ExtractionStats> getExtractionStats();
+
+        static std::shared_ptr<arrow::Schema> getDataSchema(std::shared_ptr<arrow::DataType> valueType = arrow::float64());
+        static std::shared_ptr<arrow::Schema> getDataWithLocationsSchema(std::shared_ptr<arrow::Schema> locationSchema,
+                                                                         std::shared_ptr<arrow::DataType> valueType = arrow::float64(),
+                                                                         ColumnEncoding encoding = ColumnEncoding::Dense);
+        //The columns which hold a single value for the whole message (parameterId, modelNo, forecast_date, datetime)
+        static arrow::FieldVector getMessageFields(ColumnEncoding encoding = ColumnEncoding::Dense);
+        arrow::ArrayVector getMessageColumns(long numberOfPoints);
+        std::shared_ptr<arrow::Array> getMessageColumn(std::string name, long numberOfPoints);
+        //The fields of schema named in columns (in the order given) or every field when columns is empty
+        static arrow::FieldVector selectFields(std::shared_ptr<arrow::Schema> schema, const std::vector<std::string>& columns);
+        //Builds the table the reader will be asked for ahead of time
+        //used when messages are decoded on a thread pool
+        void prefetch();
         ~ GribMessage();
 
 
@@ -85,14 +121,52 @@ class GribMessage
         long getNumericParameter(string parameterName);
         double getDoubleParameter(string parameterName);
         std::unique_ptr<GridArea> getGridArea();
-        std::vector<double> colToVector(std::shared_ptr<arrow::ChunkedArray> columnArray);
-        GribLocationData* getLocationData(std::unique_ptr<GridArea> gridArea);
+        std::string getKeyDefinition();
+        std::shared_ptr<GribLocationData> getLocationData(std::unique_ptr<GridArea>& gridArea);
+        //Finds the nearest grid point (and the interpolation weights) of each location
+        //projection is nullptr for grids without a supported projection
+        StoredLocationData matchLocations(const double* inlats, const double* inlons, long numberOfPoints,
+                                          const GridProjection* projection);
+        //Identifies the grid, the locations and how they are matched in the location store
+        std::string getLocationStoreKey(const GridArea& gridArea, const double* inlats, const double* inlons, long numberOfPoints);
+        //Reads the coordinates of every point of the grid at full precision
+        void getGridCoordinates(std::vector<double>& lats, std::vector<double>& lons);
+        //Finds the nearest grid point to each location using a kd-tree built from the coordinates of the grid
+        void findNearestWithKdTree(const KdTree& tree, const std::vector<double>& gridLats, const std::vector<double>& gridLons,
+                                   const double* inlats, const double* inlons, long numberOfPoints,
+                                   double* outlats, double* outlons, double* distances, int* indexes);
+        //Finds the nearest grid point to each location from the corners of the cell of the projection around it
+        void findNearestWithProjection(const GridProjection& projection, const std::vector<double>& gridLats, 
+                                       const std::vector<double>& gridLons, const double* inlats, const double* inlons, 
+                                       long numberOfPoints, double* outlats, double* outlons, double* distances, int* indexes);
+        //The projection of regular, rotated and lambert grids or nullptr for any other grid
+        std::shared_ptr<GridProjection> getProjection();
+        //The stencils and weights used to interpolate the value at each location, nullptr for the nearest point
+        //tree is only needed for InterpolationMethod::InverseDistance, bilinear weights use the projection when given
+        std::shared_ptr<InterpolationWeights> getInterpolationWeights(const double* inlats, const double* inlons,
+                                                                      long numberOfPoints, const KdTree* tree,
+                                                                      const GridProjection* projection = nullptr);
+        //The coordinates of every point of the grid from the cache, decoding them (and the values) when the grid is new
+        GridCoordinates getCoordinates(std::shared_ptr<arrow::Array>* decodedValues = nullptr);
+        //The indexes of the points inside the area, regular and rotated grids work out the rows and columns of the area
+        std::vector<int> getAreaIndexes(double north, double west, double south, double east);
+        std::vector<int> filterByCoordinates(const std::vector<int>& indexes, double north, double west, double south, double east);
+        //Decodes just the values of the message as the value type of the reader
+        std::shared_ptr<arrow::Array> getValues(long numberOfPoints);
+        std::shared_ptr<arrow::Array> getValuesAtLocations(std::shared_ptr<GribLocationData> location_data);
+        //Reads the values of the grid points at indexes using the strategy chosen by the reader
+        void readValuesAt(const int* indexes, long count, double* values);
+        //Uses the bitmap section of the message to mark the missing values as null
+        std::shared_ptr<arrow::Array> withMissingValues(std::shared_ptr<arrow::Array> valuesArray);
+        //Returns nullptr unless table has all of the columns
+        std::shared_ptr<arrow::Table> selectPrefetched(std::shared_ptr<arrow::Table> table, const std::vector<std::string>& columns);
         GribReader* _reader;
         codes_handle* h;
         long _message_id;
-        long gribVersion = 0;
-        double longitudeOfFirstGridPointInDegrees = 0.0;
-        double longitudeOfLastGridPointInDegrees = 0.0;
+        MessageMetadata metadata;
+        std::shared_ptr<arrow::Table> prefetchedData;
+        std::shared_ptr<arrow::Table> prefetchedLocationData;
+        std::optional<ExtractionStats> extractionStats;
    
 };
 
@@ -22,17 +22,12 @@ Iterator::Iterator(GribReader* reader,
 // Prefix increment
 Iterator& Iterator::operator++() { 
     delete m_ptr;
-    codes_handle* h = codes_handle_new_from_file(0, reader->fin, PRODUCT_GRIB, &err);
-    if (h == NULL) {
+    auto m = reader->nextMessage();
+    if (m == nullptr) {
         m_ptr = m_lastMessage;
         reader->setExhausted(true);
     } else {
-        message_id++;
-        auto m = new GribMessage(
-                reader, 
-                h, 
-                message_id
-                );
+        message_id = m->getGribMessageId();
         m_ptr = m;
     }
     return *this; 
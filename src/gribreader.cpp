@@ -1,5 +1,11 @@
 #include <vector>
 #include <algorithm>
+#include <thread>
+#include <exception>
+#include <stdexcept>
+#include <limits>
+#include <unistd.h>
+#include <sys/stat.h>
 //#include <ranges>
 #include <arrow/api.h>
 #include <arrow/dataset/dataset.h>
@@ -24,6 +30,13 @@
 #include "caster.hpp"
 #include "converter.hpp"
 #include "gribhelpers.hpp"
+#include "messagescanner.hpp"
+#include "parallelmessagedecoder.hpp"
+#include "mappedfile.hpp"
+#include "messageindex.hpp"
+#include "keyvalues.hpp"
+#include "gribrecordbatchreader.hpp"
+#include "stationtimeseries.hpp"
 #include "exceptions/nosuchgribfileexception.hpp"
 #include "exceptions/nosuchlocationsfileexception.hpp"
 #include "exceptions/arrowtablereadercreationexception.hpp"
@@ -54,6 +67,10 @@ GribReader GribReader::withLocations(std::shared_ptr<arrow::Table> locations) {
     locations = enrichLocationsWithSurrogateKey(locations);
     locations = castTableFields(locations, " passed locations via arrow",  getLocationFieldDefinitions());
     this->shared_locations = locations;
+    //Indexed once so finding the locations in the area of each grid doesn't scan the table
+    this->locationIndex = std::make_shared<LocationIndex>(locations->GetColumnByName("lat"), locations->GetColumnByName("lon"));
+    //The cached nearest points belong to the previous locations
+    resetLocationCache();
     return *this;
 }
 
@@ -90,7 +107,10 @@ std::shared_ptr<arrow::Table> GribReader::enrichLocationsWithSurrogateKey(std::s
         std::cout << "Enriching with surrogate_key field " << std::endl;
         auto numberOfRows = locationsTable->num_rows();
         auto surrogate_columns = createSurrogateKeyCol(numberOfRows);
-        auto skField = arrow::field("surrogate_key", arrow::uint16());
+        if (!surrogate_columns.ok()) {
+            throw ArrowGenericException("Unable to create surrogate key " + surrogate_columns.status().message());
+        }
+        auto skField = arrow::field("surrogate_key", surrogate_columns.ValueOrDie()->type());
         auto chunkedArray = std::make_shared<arrow::ChunkedArray>(arrow::ChunkedArray(surrogate_columns.ValueOrDie()));
         auto locationsResult = locationsTable->AddColumn(0, skField, chunkedArray);
         if (!locationsResult.ok()) {
@@ -117,6 +137,259 @@ GribReader GribReader::withRepeatableIterator(bool repeatable) {
     return *this;
 }
 
+GribReader GribReader::withMemoryMappedInput(bool enableMemoryMap) {
+    if (enableMemoryMap && !mappedFile) {
+        mappedFile = std::make_shared<MappedFile>(filepath);
+    } else if (!enableMemoryMap) {
+        mappedFile.reset();
+    }
+    return *this;
+}
+
+GribReader GribReader::withFilter(std::string key, std::vector<long> values) {
+    messageFilter.addKeyIn(key, values);
+    return *this;
+}
+
+GribReader GribReader::withFilter(std::string key, std::vector<std::string> values) {
+    messageFilter.addKeyIn(key, values);
+    return *this;
+}
+
+GribReader GribReader::withRangeFilter(std::string key, double minimum, double maximum) {
+    messageFilter.addKeyBetween(key, minimum, maximum);
+    return *this;
+}
+
+GribReader GribReader::withIndex() {
+    return withIndex(filepath + ".arrowidx");
+}
+
+GribReader GribReader::withIndex(std::string indexPath) {
+    auto index = MessageIndex::load(indexPath, filepath);
+    if (!index.has_value()) {
+        std::cout << "Building index " << indexPath << std::endl;
+        index = buildIndex();
+        index->save(indexPath, filepath);
+    }
+    messageIndex = std::make_shared<MessageIndex>(std::move(index.value()));
+    messageExtents = std::make_shared<std::vector<MessageExtent>>(messageIndex->getExtents());
+    return *this;
+}
+
+MessageIndex GribReader::buildIndex() {
+    std::vector<MessageIndexEntry> entries;
+    std::vector<unsigned char> buffer;
+    for (auto& extent : getMessageExtents()) {
+        auto h = createHeaderHandle(extent, buffer);
+        entries.push_back(MessageIndex::createEntry(extent, h));
+        codes_handle_delete(h);
+    }
+    return MessageIndex(entries);
+}
+
+std::shared_ptr<arrow::Table> GribReader::getIndex() {
+    if (!messageIndex) {
+        messageIndex = std::make_shared<MessageIndex>(buildIndex());
+    }
+    return messageIndex->toTable();
+}
+
+std::vector<std::string> GribReader::defaultInventoryKeys() {
+    return {"shortName", "paramId", "step", "level", "number", "date", "gridType", "offset", "length"};
+}
+
+std::shared_ptr<arrow::Table> GribReader::inventory(std::vector<std::string> keys) {
+
+    auto& extents = getMessageExtents();
+
+    //values[k][m] is the value of keys[k] in message m
+    std::vector<std::vector<KeyValue>> values(keys.size(), std::vector<KeyValue>(extents.size()));
+
+    auto readHeaders = [&](size_t first, size_t last) {
+        std::vector<unsigned char> buffer;
+        for (size_t m = first; m < last; m++) {
+            auto& extent = extents[m];
+            auto h = createHeaderHandle(extent, buffer);
+            for (size_t k = 0; k < keys.size(); k++) {
+                auto& key = keys[k];
+                //The position of the message comes from the scan rather than eccodes
+                if (key == "messageId") {
+                    values[k][m] = extent.messageId;
+                } else if (key == "offset") {
+                    values[k][m] = (long)extent.offset;
+                } else if (key == "length") {
+                    values[k][m] = (long)extent.length;
+                } else {
+                    values[k][m] = readKey(h, key);
+                }
+            }
+            codes_handle_delete(h);
+        }
+    };
+
+    //Every thread reads the headers of a contiguous block of messages
+    size_t threads = std::max((size_t)1, std::min((size_t)getWorkerThreads(), extents.size()));
+    size_t blockSize = (extents.size() + threads - 1) / threads;
+
+    std::vector<std::thread> workers;
+    std::vector<std::exception_ptr> errors(threads);
+    for (size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            try {
+                readHeaders(t * blockSize, std::min(extents.size(), (t + 1) * blockSize));
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    arrow::FieldVector fields;
+    arrow::ArrayVector columns;
+    for (size_t k = 0; k < keys.size(); k++) {
+        auto column = keyValuesToArrow(values[k]);
+        if (!column.ok()) {
+            throw ArrowGenericException("Unable to create inventory column " + keys[k] + " " + column.status().message());
+        }
+        fields.push_back(arrow::field(keys[k], column.ValueOrDie()->type()));
+        columns.push_back(column.ValueOrDie());
+    }
+    return arrow::Table::Make(arrow::schema(fields), columns, (int64_t)extents.size());
+}
+
+GribMessage* GribReader::getMessage(long messageId) {
+    auto& extents = getMessageExtents();
+    if (messageId < 0 || messageId >= (long)extents.size()) {
+        std::ostringstream oss;
+        oss << "Message id " << messageId << " is out of range, file " << filepath
+            << " contains " << extents.size() << " messages";
+        throw std::out_of_range(oss.str());
+    }
+    auto& extent = extents[messageId];
+    return new GribMessage(this, createHandle(extent), extent.messageId);
+}
+
+long GribReader::getNumberOfMessages() {
+    return (long)getMessageExtents().size();
+}
+
+GribReader GribReader::withValueType(std::shared_ptr<arrow::DataType> valueType) {
+    if (!valueType->Equals(arrow::float64()) && !valueType->Equals(arrow::float32())) {
+        throw InvalidSchemaException("Value type must be float64 or float32 but got " + valueType->ToString());
+    }
+    if (!valueType->Equals(this->valueType)) {
+        //The caches hold arrays of the previous type
+        resetLocationCache();
+        resetCoordinatesCache();
+    }
+    this->valueType = valueType;
+    return *this;
+}
+
+std::shared_ptr<arrow::DataType> GribReader::getValueType() {
+    return valueType;
+}
+
+GribReader GribReader::withColumns(std::vector<std::string> columns) {
+    this->columns = columns;
+    return *this;
+}
+
+std::vector<std::string> GribReader::getColumns() {
+    return columns;
+}
+
+GribReader GribReader::withConstantColumnEncoding(ColumnEncoding encoding) {
+    constantColumnEncoding = encoding;
+    return *this;
+}
+
+ColumnEncoding GribReader::getConstantColumnEncoding() {
+    return constantColumnEncoding;
+}
+
+GribReader GribReader::withNearestMethod(NearestMethod method) {
+    if (method != nearestMethod) {
+        //The cached nearest points were found by the previous method
+        resetLocationCache();
+    }
+    nearestMethod = method;
+    return *this;
+}
+
+NearestMethod GribReader::getNearestMethod() {
+    return nearestMethod;
+}
+
+GribReader GribReader::withInterpolation(InterpolationMethod method, unsigned int neighbours) {
+    if (neighbours == 0) {
+        throw std::invalid_argument("The number of neighbours used for interpolation must be at least 1");
+    }
+    if (method != interpolationMethod || neighbours != interpolationNeighbours) {
+        //The cached weights were calculated for the previous method
+        resetLocationCache();
+    }
+    interpolationMethod = method;
+    interpolationNeighbours = neighbours;
+    return *this;
+}
+
+InterpolationMethod GribReader::getInterpolationMethod() {
+    return interpolationMethod;
+}
+
+unsigned int GribReader::getInterpolationNeighbours() {
+    return interpolationNeighbours;
+}
+
+GribReader GribReader::withValueExtraction(ValueExtraction extraction) {
+    valueExtraction = extraction;
+    return *this;
+}
+
+ValueExtraction GribReader::getValueExtraction() {
+    return valueExtraction;
+}
+
+GribReader GribReader::withLocationStore(std::string directory) {
+    //An existing directory is fine, any other failure shows up when the first grid is saved
+    mkdir(directory.c_str(), 0755);
+    locationStore = std::make_shared<LocationStore>(directory);
+    return *this;
+}
+
+std::shared_ptr<LocationStore> GribReader::getLocationStore() {
+    return locationStore;
+}
+
+unsigned int GribReader::getWorkerThreads() {
+    return numberOfThreads > 1 ? numberOfThreads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+GribReader GribReader::withThreads(unsigned int numberOfThreads, unsigned int maxBufferedMessages) {
+    //0 means use every core
+    if (numberOfThreads == 0) {
+        numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    this->numberOfThreads = numberOfThreads;
+    //By default allow each worker to have 2 messages in flight
+    this->maxBufferedMessages = maxBufferedMessages == 0 ? numberOfThreads * 2 : maxBufferedMessages;
+    this->decodeBuffers = std::make_shared<BufferPool<double>>(numberOfThreads);
+    return *this;
+}
+
+std::shared_ptr<std::vector<double>> GribReader::acquireDecodeBuffer(size_t size) {
+    return decodeBuffers->acquire(size);
+}
+
 void GribReader::validateConversionFields(std::shared_ptr<arrow::Table> conversions, std::string table_name) {
     auto table = conversions.get();
     auto columns = table->ColumnNames();
@@ -232,13 +505,6 @@ GribReader GribReader::withLocations(std::string path){
 
 }
 
-enum conversionMethods {
-    Add,
-    Subtract,
-    Multiply,
-    Divide
-};
-
 enum conversionDataTypes {
     String,
     Float
@@ -274,52 +540,18 @@ GribReader GribReader::withConversions(std::shared_ptr<arrow::Table> conversions
         cout <<  "adding conversions" << endl ;
 
         
-        vector<pair<conversionMethods, optional<double>>> methods {
-                            make_pair(conversionMethods::Add, row.additionValue), 
-                            make_pair(conversionMethods::Subtract, row.subtractionValue), 
-                            make_pair(conversionMethods::Multiply, row.multiplicationValue), 
-                            make_pair(conversionMethods::Divide , row.divisionValue)
-        };
-
-        pair<conversionMethods, optional<double>> firstMatch;
-        bool match = false;
-        for(auto row: methods) {
-            if(row.second.has_value()) {
-                match = true;
-                firstMatch = row;
-            }
+        //Every operation of the row is applied, a row without any operations doesn't convert the values
+        bool hasConversion = row.additionValue || row.subtractionValue || row.multiplicationValue 
+                             || row.divisionValue || row.ceilingValue;
 
-        }
-
-        if (match) {
+        if (hasConversion) {
             cout << "Adding to cache for " << row.parameterId << endl;
- 
-            std::function<arrow::Result<arrow::Datum>(arrow::Datum, arrow::Datum)> conversionFunc;
-
-            switch(firstMatch.first) {
-                case conversionMethods::Add:
-                    conversionFunc = [](arrow::Datum lhs, arrow::Datum rhs) {
-                        return cp::Add(lhs, rhs);
-                    };
-                    break;
-                case conversionMethods::Subtract:
-                    conversionFunc = [](arrow::Datum lhs, arrow::Datum rhs) {
-                        return cp::Subtract(lhs, rhs);
-                    };
-                    break;
-                case conversionMethods::Multiply:
-                    conversionFunc = [](arrow::Datum lhs, arrow::Datum rhs) {
-                        return cp::Multiply(lhs, rhs);
-                    };
-                    break;
-                case conversionMethods::Divide:
-                    conversionFunc = [](arrow::Datum lhs, arrow::Datum rhs) {
-                        return cp::Divide(lhs, rhs);
-                    };
-                    break;
-            }
 
-            auto converter = new Converter(conversionFunc, firstMatch.second.value());
+            auto converter = new Converter(row.additionValue, 
+                                           row.subtractionValue, 
+                                           row.multiplicationValue, 
+                                           row.divisionValue, 
+                                           row.ceilingValue);
 
             conversion_funcs.emplace(row.parameterId, converter);
             
@@ -345,17 +577,43 @@ Iterator GribReader::begin() {
     }
     if (!isExhausted || isRepeatable) {
         std::cout << "Creating iterator" << endl;
-        codes_handle* h = codes_handle_new_from_file(0, fin, PRODUCT_GRIB, &err);
-        std::cout << "handle is " << h << std::endl;
-        if(h == nullptr || h == NULL || err != 0) {
+        //Release any previous decoder (and its threads) before starting again
+        decoder.reset();
+        nextMessageId = 0;
+        GribMessage* m;
+        if (usesMessageExtents()) {
+            auto& extents = getMessageExtents();
+            if (extents.empty()) {
+                throw GribException("Unable to find any grib messages whilst processing file " + filepath);
+            }
+            if (numberOfThreads > 1) {
+                decoder = std::make_shared<ParallelMessageDecoder>(this, extents, numberOfThreads, maxBufferedMessages);
+            }
+            m = nextMessage();
+        } else {
+            codes_handle* h = codes_handle_new_from_file(0, fin, PRODUCT_GRIB, &err);
+            std::cout << "handle is " << h << std::endl;
+            if(h == nullptr || h == NULL || err != 0) {
 
-            std::ostringstream oss;
-            oss << "Error calling codes_handle_new_from_file got error code " << err
-             << " whilst processing file " << filepath;
+                std::ostringstream oss;
+                oss << "Error calling codes_handle_new_from_file got error code " << err
+                 << " whilst processing file " << filepath;
 
-            throw GribException (oss.str());
+                throw GribException (oss.str());
+            }
+            auto messageId = nextMessageId++;
+            if (messageFilter.matches(h)) {
+                m = new GribMessage(this, h, messageId);
+            } else {
+                codes_handle_delete(h);
+                m = nextMessage();
+            }
+        }
+        if (m == nullptr) {
+            //Every message was filtered out
+            setExhausted(true);
+            return Iterator( this,  m_endMessage, m_endMessage );
         }
-        auto m = new GribMessage(this, h, 0l);
         return Iterator(this, m, m_endMessage);
     } else {
         std::cout << "Iterator is exhausted returning end_message" << endl;
@@ -363,90 +621,295 @@ Iterator GribReader::begin() {
     }
 }
 
+bool GribReader::usesMessageExtents() {
+    return numberOfThreads > 1 || mappedFile || readsByOffset;
+}
+
+GribMessage* GribReader::nextMessage() {
+    if (decoder) {
+        return decoder->next();
+    }
+    if (usesMessageExtents()) {
+        auto& extents = getMessageExtents();
+        while (nextMessageId < (long)extents.size()) {
+            auto& extent = extents[nextMessageId++];
+            if (acceptsMessage(extent)) {
+                return new GribMessage(this, createHandle(extent), extent.messageId);
+            }
+        }
+        return nullptr;
+    }
+    while (true) {
+        codes_handle* h = codes_handle_new_from_file(0, fin, PRODUCT_GRIB, &err);
+        if (h == NULL) {
+            return nullptr;
+        }
+        auto messageId = nextMessageId++;
+        //The data section hasn't been decoded at this point so skipping the message is cheap
+        if (messageFilter.matches(h)) {
+            return new GribMessage(this, h, messageId);
+        }
+        codes_handle_delete(h);
+    }
+}
+
+bool GribReader::acceptsMessage(const MessageExtent& extent) {
+    if (messageFilter.empty()) {
+        return true;
+    }
+    //Avoid touching the message at all if the index holds the keys
+    if (messageIndex) {
+        auto indexed = messageFilter.matches((*messageIndex)[extent.messageId]);
+        if (indexed.has_value()) {
+            return indexed.value();
+        }
+    }
+    std::vector<unsigned char> buffer;
+    auto h = createHeaderHandle(extent, buffer);
+    auto accepted = messageFilter.matches(h);
+    codes_handle_delete(h);
+    return accepted;
+}
+
+const std::vector<MessageExtent>& GribReader::getMessageExtents() {
+    if (!messageExtents) {
+        auto extents = mappedFile ? findMessageExtents(mappedFile->data(), mappedFile->size())
+                                  : findMessageExtents(fin);
+        messageExtents = std::make_shared<std::vector<MessageExtent>>(std::move(extents));
+    }
+    return *messageExtents;
+}
+
+codes_handle* GribReader::createHandle(const MessageExtent& extent) {
+
+    if (mappedFile) {
+        //The handle points straight at the mapped message so nothing is copied,
+        //the mapping lives as long as the reader
+        auto h = codes_handle_new_from_message(0, mappedFile->data() + extent.offset, extent.length);
+        if (h == NULL) {
+            std::ostringstream oss;
+            oss << "Error calling codes_handle_new_from_message for message id " << extent.messageId
+                << " whilst processing file " << filepath;
+            throw GribException(oss.str());
+        }
+        return h;
+    }
+
+    std::vector<unsigned char> buffer;
+    readMessage(extent, buffer);
+
+    auto h = codes_handle_new_from_message_copy(0, buffer.data(), buffer.size());
+    if (h == NULL) {
+        std::ostringstream oss;
+        oss << "Error calling codes_handle_new_from_message_copy for message id " << extent.messageId
+            << " whilst processing file " << filepath;
+        throw GribException(oss.str());
+    }
+    return h;
+}
+
+codes_handle* GribReader::createHeaderHandle(const MessageExtent& extent, std::vector<unsigned char>& buffer) {
+
+    const unsigned char* message;
+    if (mappedFile) {
+        message = mappedFile->data() + extent.offset;
+    } else {
+        readMessage(extent, buffer);
+        message = buffer.data();
+    }
+
+    auto h = codes_handle_new_from_partial_message(0, message, extent.length);
+    if (h == NULL) {
+        std::ostringstream oss;
+        oss << "Error calling codes_handle_new_from_partial_message for message id " << extent.messageId
+            << " whilst processing file " << filepath;
+        throw GribException(oss.str());
+    }
+    return h;
+}
+
+void GribReader::readMessage(const MessageExtent& extent, std::vector<unsigned char>& buffer) {
+
+    //pread doesn't move the file position so threads can read different messages at the same time
+    buffer.resize(extent.length);
+    auto bytesRead = pread(fileno(fin), buffer.data(), extent.length, extent.offset);
+    if (bytesRead != (ssize_t)extent.length) {
+        std::ostringstream oss;
+        oss << "Unable to read " << extent.length << " bytes at offset " << extent.offset
+            << " for message id " << extent.messageId << " whilst processing file " << filepath;
+        throw GribException(oss.str());
+    }
+}
+
 Iterator GribReader::end()   {
 
     return Iterator( this,  m_endMessage, m_endMessage );
 
 } 
 
-std::optional<GribLocationData*> GribReader::getLocationDataFromCache(std::unique_ptr<GridArea>& area) {
+std::shared_ptr<GribLocationData> GribReader::getLocationDataFromCache(std::unique_ptr<GridArea>& area) {
+    return location_cache->get(*area.get());
+}
 
-    //check the cache
-    auto ga = *area.get();
-    auto cache_result = location_cache.find(ga);
-    return cache_result != location_cache.end() ? std::optional<GribLocationData*> {cache_result->second}
-                                         : std::nullopt;
+std::shared_ptr<GribLocationData> GribReader::addLocationDataToCache(std::unique_ptr<GridArea>& area, std::shared_ptr<GribLocationData> locationData) {
+    return location_cache->put(*area.get(), locationData, locationData->getSizeInBytes());
 }
 
-GribLocationData* GribReader::addLocationDataToCache(std::unique_ptr<GridArea>& area, GribLocationData* locationData) {
+std::shared_ptr<GribLocationData> GribReader::getOrSearchLocationData(std::unique_ptr<GridArea>& area, 
+                                                                      const std::function<std::shared_ptr<GribLocationData>()>& search) {
+    if (auto cached = location_cache->get(*area.get())) {
+        return cached;
+    }
+
+    //Held on to as withLocations replaces the searches of the reader
+    auto searches = location_searches;
+    std::promise<std::shared_ptr<GribLocationData>> promise;
+    std::shared_future<std::shared_ptr<GribLocationData>> pending;
+    bool searching;
+    {
+        std::lock_guard<std::mutex> lock(*locationDataMutex);
+        auto [found, added] = searches->emplace(*area.get(), promise.get_future().share());
+        pending = found->second;
+        searching = added;
+    }
+    if (!searching) {
+        //Rethrows the exception if the other search failed
+        return pending.get();
+    }
+
+    try {
+        promise.set_value(addLocationDataToCache(area, search()));
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+    }
+    {
+        std::lock_guard<std::mutex> lock(*locationDataMutex);
+        searches->erase(*area.get());
+    }
+    return pending.get();
+}
+
+void GribReader::resizeLocationDataInCache(std::unique_ptr<GridArea>& area, std::shared_ptr<GribLocationData> locationData) {
+    location_cache->resize(*area.get(), locationData, locationData->getSizeInBytes());
+}
+
+std::optional<GridCoordinates> GribReader::getCoordinatesFromCache(std::unique_ptr<GridArea>& area) {
+    auto coordinates = coordinates_cache->get(*area.get());
+    return coordinates ? std::optional<GridCoordinates> {*coordinates} : std::nullopt;
+}
+
+GridCoordinates GribReader::addCoordinatesToCache(std::unique_ptr<GridArea>& area, GridCoordinates coordinates) {
+    auto cached = std::make_shared<GridCoordinates>(coordinates);
+    return *coordinates_cache->put(*area.get(), cached, cached->getSizeInBytes());
+}
+
+//Other copies of the reader keep the previous cache as it matches their settings
+void GribReader::resetLocationCache() {
+    location_cache = std::make_shared<LruCache<GridArea, GribLocationData>>(cacheLimit);
+    location_searches = std::make_shared<LocationSearches>();
+}
+
+void GribReader::resetCoordinatesCache() {
+    coordinates_cache = std::make_shared<LruCache<GridArea, GridCoordinates>>(cacheLimit);
+}
+
+GribReader GribReader::withCacheLimit(uint64_t capacityBytes) {
+    cacheLimit = capacityBytes;
+    location_cache->setCapacity(capacityBytes);
+    coordinates_cache->setCapacity(capacityBytes);
+    return *this;
+}
+
+std::map<std::string, CacheStats> GribReader::getCacheStats() {
+    return {{"locations", location_cache->getStats()}, {"coordinates", coordinates_cache->getStats()}};
+}
+
+std::mutex& GribReader::getLocationDataMutex() {
+    return *locationDataMutex;
+}
 
-    auto a = *area.get();
-    location_cache.emplace(a, locationData);
-    return locationData;
+KeyTypeCache& GribReader::getKeyTypeCache() {
+    return *keyTypeCache;
+}
 
+std::shared_ptr<arrow::Table> GribReader::getLocations() {
+    return shared_locations;
 }
 
-std::shared_ptr<arrow::Table> GribReader::getLocations(std::unique_ptr<GridArea>& area) {
+std::shared_ptr<arrow::Int64Array> GribReader::selectLocations(std::unique_ptr<GridArea>& area, const GridProjection* projection) {
 
     if (!filteringEnabled) {
-        return shared_locations;
+        return nullptr;
     }
 
+    //Only called when the location data of the area isn't cached, the selection is kept (and counted) with it
     auto ga = *area.get();
 
-    if (auto search = locations_in_area.find(ga); search != locations_in_area.end()) {
-            std::cout << "Found area" << std::endl;
-    }
-    else {
-            auto latDirection = ga.m_jScansPositively;   
-            auto lonDirection = ga.m_iScansNegatively;         
+    auto latDirection = ga.m_jScansPositively;   
+    auto lonDirection = ga.m_iScansNegatively;         
 
-            cp::Expression c1, c2, c3, c4;
+    auto minLat = latDirection ? ga.m_latitudeOfFirstPoint : ga.m_latitudeOfLastPoint;
+    auto maxLat = latDirection ? ga.m_latitudeOfLastPoint : ga.m_latitudeOfFirstPoint;
+    auto minLon = lonDirection ? ga.m_longitudeOfLastPoint : ga.m_longitudeOfFirstPoint;
+    auto maxLon = lonDirection ? ga.m_longitudeOfFirstPoint : ga.m_longitudeOfLastPoint;
 
-            if(latDirection) {
-                c1 = cp::greater_equal(cp::field_ref("lat"), cp::literal(ga.m_latitudeOfFirstPoint));
-                c2 = cp::less_equal(cp::field_ref("lat"), cp::literal(ga.m_latitudeOfLastPoint));
-            } else {
-                c1 = cp::less_equal(cp::field_ref("lat"), cp::literal(ga.m_latitudeOfFirstPoint));
-                c2 = cp::greater_equal(cp::field_ref("lat"), cp::literal(ga.m_latitudeOfLastPoint));
-            }
-            if(lonDirection) {
-                c3 = cp::less_equal(cp::field_ref("lon"), cp::literal(ga.m_longitudeOfFirstPoint));
-                c4 = cp::greater_equal(cp::field_ref("lon"), cp::literal(ga.m_longitudeOfLastPoint));
-            } else {
-                c3 = cp::greater_equal(cp::field_ref("lon"), cp::literal(ga.m_longitudeOfFirstPoint));
-                c4 = cp::less_equal(cp::field_ref("lon"), cp::literal(ga.m_longitudeOfLastPoint));
-            }
+    //The rows and columns of a projected grid aren't parallels and meridians so every location is projected
+    auto selection = projection 
+        ? locationIndex->select(-90, 90, -360, 360, [projection](double lat, double lon) { return projection->contains(lat, lon); })
+        : locationIndex->select(minLat, maxLat, minLon, maxLon);
 
-            auto filterCondition = cp::and_({c1,c2,c3,c4});
+    cout << "Selected " << selection->length() << " locations for area " << ga << endl;
+    //Every location is in the area so the columns can be shared
+    return selection->length() == shared_locations->num_rows() ? nullptr : selection;
+}
 
-            // Wrap the Table in a Dataset so we can use a Scanner
-            std::shared_ptr<arrow::dataset::Dataset> dataset =
-                    std::make_shared<arrow::dataset::InMemoryDataset>(shared_locations);
+std::shared_ptr<arrow::Schema> GribReader::getLocationSchema() {
+    return shared_locations->schema();
+}
 
-            auto options = std::make_shared<arrow::dataset::ScanOptions>();
-            options->filter = filterCondition;
-            
-            auto builder = arrow::dataset::ScannerBuilder(dataset, options);
-            auto scanner = builder.Finish();
-
-            if (scanner.ok()) {
-            // Perform the Scan and make a Table with the result
-                auto result = scanner.ValueUnsafe()->ToTable();
-                cout << "Successfully filtered location table for area " << ga << endl;
-                auto filteredResults = result.ValueOrDie();
-                cout << "Filtered table has "<< filteredResults.get()->num_rows() << " rows" << endl;
-                locations_in_area.emplace(std::make_pair(ga, filteredResults));
-                std::cout << "Added locations to cache\n";
-            } else {
-                cout << "OH NO" << endl;
-            }
-            
+std::shared_ptr<arrow::RecordBatchReader> GribReader::toRecordBatchReader() {
+    return std::make_shared<GribRecordBatchReader>(independentCopy());
+}
+
+GribReader GribReader::independentCopy() {
+    GribReader copy(*this);
+    copy.readsByOffset = true;
+    copy.isExhausted = false;
+    copy.nextMessageId = 0;
+    //The decoder belongs to the iteration of this reader
+    copy.decoder.reset();
+    return copy;
+}
+
+std::shared_ptr<arrow::Table> GribReader::toStationTimeSeries() {
+
+    if (!hasLocations()) {
+        throw InvalidSchemaException("toStationTimeSeries needs the locations to be passed to the reader using withLocations");
+    }
+
+    //Decoded on an independent copy so the columns and file position of this reader aren't changed,
+    //only the keys and values of each message are built
+    GribReader reader = independentCopy();
+    reader.withColumns({"surrogate_key", "value"});
+    StationTimeSeries series(shared_locations, valueType);
+
+    auto last = reader.end();
+    for (auto current = reader.begin(); current != last; ++current) {
+        try {
+            auto table = current->getDataWithLocations();
+            auto validTime = std::chrono::duration_cast<std::chrono::microseconds>(current->getObsDate().time_since_epoch()).count();
+            //A single chunk so messages on the same grid share the surrogate key array of the grid
+            series.add(current->getParameterId(), validTime, 
+                       table->GetColumnByName("surrogate_key")->chunk(0), 
+                       table->GetColumnByName("value")->chunk(0));
+        } catch (...) {
+            //The iterator only deletes the message when it moves on
+            delete current.operator->();
+            throw;
+        }
     }
 
-    //auto required_locations = locations_in_area.find(ga);
-    auto matched =  locations_in_area[ga];
-    return matched;
+    return series.toTable();
 }
 
 bool GribReader::hasLocations() {
@@ -487,21 +950,21 @@ std::shared_ptr<arrow::Table> GribReader::getTableFromCsv(std::string path, arro
 
 arrow::Result<std::shared_ptr<arrow::Array>> GribReader::createSurrogateKeyCol(long numberOfRows){
 
-    vector<uint16_t> row_ids;
-    for(auto i =0 ; i <  numberOfRows; ++i) {
-        row_ids.emplace_back(i);
-    }
-
-    arrow::UInt16Builder surrogateBuilder;
-    ARROW_RETURN_NOT_OK(surrogateBuilder.AppendValues(row_ids));
-    std::shared_ptr<arrow::Array> arrayValues;
-    ARROW_ASSIGN_OR_RAISE(arrayValues,surrogateBuilder.Finish());
-    return arrayValues;
-
- }
+    //uint32 covers any realistic set of locations, larger tables fall back to uint64
+    auto fillRowIds = [numberOfRows](auto* rowIds) {
+        for (long i = 0; i < numberOfRows; ++i) {
+            rowIds[i] = i;
+        }
+    };
 
-void GribReader::setExhausted(bool status) {
-    isExhausted = status;
+    if (numberOfRows <= (long)std::numeric_limits<uint32_t>::max()) {
+        ARROW_ASSIGN_OR_RAISE(std::shared_ptr<arrow::Buffer> buffer, arrow::AllocateBuffer(numberOfRows * sizeof(uint32_t)));
+        fillRowIds((uint32_t*)buffer->mutable_data());
+        return std::make_shared<arrow::UInt32Array>(numberOfRows, buffer);
+    }
+    ARROW_ASSIGN_OR_RAISE(std::shared_ptr<arrow::Buffer> buffer, arrow::AllocateBuffer(numberOfRows * sizeof(uint64_t)));
+    fillRowIds((uint64_t*)buffer->mutable_data());
+    return std::make_shared<arrow::UInt64Array>(numberOfRows, buffer);
 }
 
 std::string GribReader::getFilePath() {
@@ -1,7 +1,11 @@
 #pragma once
 
 #include <iterator>
+#include <functional>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <arrow/api.h>
 #include <arrow/csv/api.h>
@@ -10,6 +14,20 @@
 #include "gribmessageiterator.hpp"
 #include "caster.hpp"
 #include "griblocationdata.hpp"
+#include "gridcoordinates.hpp"
+#include "messagescanner.hpp"
+#include "messageindex.hpp"
+#include "messagefilter.hpp"
+#include "arrowutils.hpp"
+#include "keyvalues.hpp"
+#include "kdtree.hpp"
+#include "interpolation.hpp"
+#include "valueextraction.hpp"
+#include "locationindex.hpp"
+#include "locationstore.hpp"
+#include "lrucache.hpp"
+#include "bufferpool.hpp"
+#include "projection.hpp"
 
 
 
@@ -19,6 +37,10 @@ class GribLocationData;
 
 class Converter;
 
+class ParallelMessageDecoder;
+
+class MappedFile;
+
 class GribReader 
 {
 
@@ -35,18 +57,99 @@ public:
     GribReader withConversions(std::string path);
     GribReader withRepeatableIterator(bool repeatable);
     GribReader withEnabledStationFiltering(bool enableFiltering);
+    GribReader withThreads(unsigned int numberOfThreads, unsigned int maxBufferedMessages = 0);
+    GribReader withMemoryMappedInput(bool enableMemoryMap);
+    GribReader withFilter(std::string key, std::vector<long> values);
+    GribReader withFilter(std::string key, std::vector<std::string> values);
+    GribReader withRangeFilter(std::string key, double minimum, double maximum);
+    GribReader withIndex();
+    GribReader withIndex(std::string indexPath);
+    GribReader withValueType(std::shared_ptr<arrow::DataType> valueType);
+    GribReader withColumns(std::vector<std::string> columns);
+    GribReader withConstantColumnEncoding(ColumnEncoding encoding);
+    GribReader withNearestMethod(NearestMethod method);
+    GribReader withInterpolation(InterpolationMethod method, unsigned int neighbours = 4);
+    GribReader withValueExtraction(ValueExtraction extraction);
+    GribReader withLocationStore(std::string directory);
+    GribReader withCacheLimit(uint64_t capacityBytes);
 
     Iterator begin();
     Iterator end();
 
+    //Returns the message after the last one returned or nullptr when there are no more messages
+    GribMessage* nextMessage();
+    //Checks the filters against the headers of the message
+    bool acceptsMessage(const MessageExtent& extent);
+    codes_handle* createHandle(const MessageExtent& extent);
+    const std::vector<MessageExtent>& getMessageExtents();
+    //Creates a handle which only decodes the headers of the message
+    //buffer holds the message when the file isn't memory mapped so must outlive the handle
+    codes_handle* createHeaderHandle(const MessageExtent& extent, std::vector<unsigned char>& buffer);
+
+    //Random access to the messages in the file
+    GribMessage* getMessage(long messageId);
+    long getNumberOfMessages();
+    std::shared_ptr<arrow::Table> getIndex();
+    //A row per message with a column per key read from the headers only (the equivalent of grib_ls)
+    //messageId, offset and length give the position of the message in the file
+    std::shared_ptr<arrow::Table> inventory(std::vector<std::string> keys = defaultInventoryKeys());
+    static std::vector<std::string> defaultInventoryKeys();
+
     //TODO Refactor this to use optional
     bool hasLocations();
-    std::shared_ptr<arrow::Table> getLocations(std::unique_ptr<GridArea>& area);
+    std::shared_ptr<arrow::Table> getLocations();
+    //The rows of the locations within the corners of the area or, for projected grids, within the grid of the projection
+    //nullptr when every location is in the area
+    std::shared_ptr<arrow::Int64Array> selectLocations(std::unique_ptr<GridArea>& area, const GridProjection* projection = nullptr);
+    std::shared_ptr<arrow::Schema> getLocationSchema();
+    //The type of the values, coordinates and distances returned by the messages (float64 or float32)
+    std::shared_ptr<arrow::DataType> getValueType();
+    //The columns returned by getData / getDataWithLocations when none are given, empty means every column
+    std::vector<std::string> getColumns();
+    //How the columns which are constant for a message (parameterId, modelNo, forecast_date, datetime) are stored
+    ColumnEncoding getConstantColumnEncoding();
+    //How the nearest grid point to each location is found
+    NearestMethod getNearestMethod();
+    //How the value at each location is calculated from the grid
+    InterpolationMethod getInterpolationMethod();
+    //The number of points used by InterpolationMethod::InverseDistance
+    unsigned int getInterpolationNeighbours();
+    //How the values at the locations are read from each message
+    ValueExtraction getValueExtraction();
+    //A scratch buffer of size values for decoding a whole field, returned to the reader when it is dropped
+    std::shared_ptr<std::vector<double>> acquireDecodeBuffer(size_t size);
+    //Where the locations matched to each grid are saved, nullptr unless withLocationStore was called
+    std::shared_ptr<LocationStore> getLocationStore();
+    //The number of threads used by work which is split across every core when withThreads hasn't been called
+    unsigned int getWorkerThreads();
+
+    //Streams the results of every message in the file
+    std::shared_ptr<arrow::RecordBatchReader> toRecordBatchReader();
+    //A copy which reads each message at its offset in the file (see getMessageExtents) starting from the first message
+    //so iterating the copy doesn't move the file position of this reader
+    GribReader independentCopy();
+    //Reads every message into a table with a row per location and a column per parameter and valid time
+    std::shared_ptr<arrow::Table> toStationTimeSeries();
 
     std::optional<std::function<arrow::Result<std::shared_ptr<arrow::Array>>(std::shared_ptr<arrow::Array>)>> getConversions(long parameterId);
 
-    std::optional<GribLocationData*> getLocationDataFromCache(std::unique_ptr<GridArea>& area);
-    GribLocationData* addLocationDataToCache(std::unique_ptr<GridArea>& area, GribLocationData* locationData);
+    std::shared_ptr<GribLocationData> getLocationDataFromCache(std::unique_ptr<GridArea>& area);
+    //Returns the location data already in the cache if another message added it first
+    std::shared_ptr<GribLocationData> addLocationDataToCache(std::unique_ptr<GridArea>& area, std::shared_ptr<GribLocationData> locationData);
+    //Returns the cached location data of the area or runs search to add it, other threads asking for the same area wait
+    //for that search rather than repeating it while threads asking for other areas aren't held up
+    std::shared_ptr<GribLocationData> getOrSearchLocationData(std::unique_ptr<GridArea>& area, 
+                                                              const std::function<std::shared_ptr<GribLocationData>()>& search);
+    //Called when the location data has gathered more columns so the cache counts them
+    void resizeLocationDataInCache(std::unique_ptr<GridArea>& area, std::shared_ptr<GribLocationData> locationData);
+    std::optional<GridCoordinates> getCoordinatesFromCache(std::unique_ptr<GridArea>& area);
+    //Returns the coordinates already in the cache if another message added them first
+    GridCoordinates addCoordinatesToCache(std::unique_ptr<GridArea>& area, GridCoordinates coordinates);
+    //Guards the searches for location data which are in progress, the caches have their own locks
+    std::mutex& getLocationDataMutex();
+    KeyTypeCache& getKeyTypeCache();
+    //The hits, misses and evictions of the location ("locations") and coordinate ("coordinates") caches
+    std::map<std::string, CacheStats> getCacheStats();
 
     void setExhausted(bool status);
     std::string getFilePath();
@@ -57,11 +160,44 @@ public:
         bool isRepeatable = false;
         bool filteringEnabled = true;
         bool isExhausted  = false;
+        unsigned int numberOfThreads = 1;
+        //Keeps a decode buffer for each thread decoding messages
+        std::shared_ptr<BufferPool<double>> decodeBuffers = std::make_shared<BufferPool<double>>(1);
+        unsigned int maxBufferedMessages = 0;
+        //Messages are read at their offsets rather than from the file position of fin
+        bool readsByOffset = false;
+        std::shared_ptr<ParallelMessageDecoder> decoder;
+        std::shared_ptr<MappedFile> mappedFile;
+        std::shared_ptr<std::vector<MessageExtent>> messageExtents;
+        std::shared_ptr<MessageIndex> messageIndex;
+        long nextMessageId = 0;
+        MessageFilter messageFilter;
+        std::shared_ptr<arrow::DataType> valueType = arrow::float64();
+        std::vector<std::string> columns;
+        ColumnEncoding constantColumnEncoding = ColumnEncoding::Dense;
+        NearestMethod nearestMethod = NearestMethod::Eccodes;
+        InterpolationMethod interpolationMethod = InterpolationMethod::Nearest;
+        unsigned int interpolationNeighbours = 4;
+        ValueExtraction valueExtraction = ValueExtraction::Auto;
+        std::shared_ptr<LocationStore> locationStore;
+        std::shared_ptr<std::mutex> locationDataMutex = std::make_shared<std::mutex>();
+        std::shared_ptr<KeyTypeCache> keyTypeCache = std::make_shared<KeyTypeCache>();
         std::shared_ptr<arrow::Table> shared_locations;
-        std::unordered_map<GridArea, std::shared_ptr<arrow::Table>> locations_in_area;
-        std::unordered_map<GridArea, GribLocationData*> location_cache;
+        std::shared_ptr<LocationIndex> locationIndex;
+        //Each cache may use up to cacheLimit bytes before the least recently used grids are evicted
+        uint64_t cacheLimit = 1024 * 1024 * 1024;
+        std::shared_ptr<LruCache<GridArea, GribLocationData>> location_cache = std::make_shared<LruCache<GridArea, GribLocationData>>(cacheLimit);
+        //The areas whose nearest points are being searched for, guarded by locationDataMutex
+        using LocationSearches = std::unordered_map<GridArea, std::shared_future<std::shared_ptr<GribLocationData>>>;
+        std::shared_ptr<LocationSearches> location_searches = std::make_shared<LocationSearches>();
+        std::shared_ptr<LruCache<GridArea, GridCoordinates>> coordinates_cache = std::make_shared<LruCache<GridArea, GridCoordinates>>(cacheLimit);
+        void resetLocationCache();
+        void resetCoordinatesCache();
         std::unordered_map<int64_t, Converter*> conversion_funcs;
         GribMessage*        m_endMessage;
+        bool usesMessageExtents();
+        MessageIndex buildIndex();
+        void readMessage(const MessageExtent& extent, std::vector<unsigned char>& buffer);
         std::shared_ptr<arrow::Table> getTableFromCsv(std::string path, arrow::csv::ConvertOptions convertOptions);
         arrow::Result<std::shared_ptr<arrow::Array>> createSurrogateKeyCol(long numberOfRows);
         void validateConversionFields(std::shared_ptr<arrow::Table> conversions, std::string table_name);
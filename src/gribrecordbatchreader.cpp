@@ -0,0 +1,72 @@
+#include <arrow/api.h>
+#include "gribrecordbatchreader.hpp"
+#include "gribmessage.hpp"
+
+GribRecordBatchReader::GribRecordBatchReader(GribReader reader) : reader(new GribReader(reader)) {
+
+    std::shared_ptr<arrow::Schema> fullSchema;
+    if (this->reader->hasLocations()) {
+        fullSchema = GribMessage::getDataWithLocationsSchema(this->reader->getLocationSchema(),
+                                                             this->reader->getValueType(),
+                                                             this->reader->getConstantColumnEncoding());
+    } else {
+        auto fields = GribMessage::getDataSchema(this->reader->getValueType())->fields();
+        for (auto field : GribMessage::getMessageFields(this->reader->getConstantColumnEncoding())) {
+            fields.push_back(field);
+        }
+        fullSchema = arrow::schema(fields);
+    }
+    m_schema = arrow::schema(GribMessage::selectFields(fullSchema, this->reader->getColumns()));
+
+    //Messages decoded ahead of time on the thread pool then build exactly the columns of the stream
+    this->reader->withColumns(m_schema->field_names());
+}
+
+GribRecordBatchReader::~GribRecordBatchReader() {
+    //The stream was abandoned part way through so the current message would otherwise leak
+    if (started && *current != *last) {
+        delete current->operator->();
+    }
+}
+
+std::shared_ptr<arrow::Schema> GribRecordBatchReader::schema() const {
+    return m_schema;
+}
+
+arrow::Status GribRecordBatchReader::ReadNext(std::shared_ptr<arrow::RecordBatch>* batch) {
+
+    try {
+        //The first message is read when the first batch is requested rather than when the stream is created
+        if (!started) {
+            started = true;
+            current = std::make_unique<Iterator>(reader->begin());
+            last = std::make_unique<Iterator>(reader->end());
+        } else if (*current != *last) {
+            ++(*current);
+        }
+
+        if (*current == *last) {
+            //Signals the end of the stream
+            *batch = nullptr;
+            return arrow::Status::OK();
+        }
+
+        ARROW_ASSIGN_OR_RAISE(*batch, messageToBatch(**current));
+        return arrow::Status::OK();
+
+    } catch (const std::exception& e) {
+        return arrow::Status::IOError(e.what());
+    }
+}
+
+arrow::Result<std::shared_ptr<arrow::RecordBatch>> GribRecordBatchReader::messageToBatch(GribMessage& message) {
+
+    auto table = reader->hasLocations() ? message.getDataWithLocations() : message.getData();
+
+    ARROW_ASSIGN_OR_RAISE(auto batch, table->CombineChunksToBatch());
+    if (!batch->schema()->Equals(*m_schema, false)) {
+        return arrow::Status::Invalid("Message ", message.getGribMessageId(), " has schema ",
+                                      batch->schema()->ToString(), " expected ", m_schema->ToString());
+    }
+    return batch;
+}
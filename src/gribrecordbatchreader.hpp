@@ -0,0 +1,37 @@
+#ifndef GRIB_RECORD_BATCH_READER_H_INCLUDED
+#define GRIB_RECORD_BATCH_READER_H_INCLUDED
+
+#include <memory>
+#include <arrow/api.h>
+#include "gribreader.hpp"
+#include "gribmessageiterator.hpp"
+
+// Streams every message in the file as a single arrow RecordBatchReader.
+// Each message becomes one record batch so only one message is held in memory at a time.
+// If the reader has locations the batches are the results of getDataWithLocations otherwise
+// they are the results of getData along with the parameterId, modelNo, forecast_date and
+// datetime of the message.
+class GribRecordBatchReader : public arrow::RecordBatchReader
+{
+
+    public:
+
+        // Takes a copy of the reader so the stream can outlive the reader it was created from
+        GribRecordBatchReader(GribReader reader);
+        ~GribRecordBatchReader();
+
+        std::shared_ptr<arrow::Schema> schema() const override;
+        arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch>* batch) override;
+
+    private:
+
+        std::unique_ptr<GribReader> reader;
+        std::unique_ptr<Iterator> current;
+        std::unique_ptr<Iterator> last;
+        std::shared_ptr<arrow::Schema> m_schema;
+        bool started = false;
+
+        arrow::Result<std::shared_ptr<arrow::RecordBatch>> messageToBatch(GribMessage& message);
+};
+
+#endif /* GRIB_RECORD_BATCH_READER_H_INCLUDED */
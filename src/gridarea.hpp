@@ -2,7 +2,9 @@
 #define GRID_AREA_H_INCLUDED
 
 #include <functional>
+#include <string>
 #include "caster.hpp"
+#include "stablehash.hpp"
 #include <sstream>
 
 
@@ -20,6 +22,8 @@ class GridArea
         const bool m_iScansNegatively;
         const bool m_jScansPositively;
         const long m_numberOfPoints;
+        //Identifies the rest of the grid definition (md5GridSection) so grids with the same corners aren't confused
+        const std::string m_gridDefinition;
         friend ostream& operator<<(ostream &os, const  GridArea& a);
 
 
@@ -29,13 +33,15 @@ class GridArea
                 const double longitudeOfLastPoint,
                 const bool iScansNegatively,
                 const bool jScansPositively,
-                const long numberOfPoints) : m_latitudeOfFirstPoint(latitudeOfFirstPoint),
+                const long numberOfPoints,
+                const std::string gridDefinition = "") : m_latitudeOfFirstPoint(latitudeOfFirstPoint),
                                              m_longitudeOfFirstPoint(longitudeOfFirstPoint),
                                              m_latitudeOfLastPoint(latitudeOfLastPoint),
                                              m_longitudeOfLastPoint(longitudeOfLastPoint),
                                              m_iScansNegatively(iScansNegatively),
                                              m_jScansPositively(jScansPositively),
-                                             m_numberOfPoints(numberOfPoints) {}
+                                             m_numberOfPoints(numberOfPoints),
+                                             m_gridDefinition(gridDefinition) {}
 
         // Match all fields incase of collision
         bool operator==(const GridArea& other) const
@@ -46,7 +52,22 @@ class GridArea
                     && m_longitudeOfLastPoint == other.m_longitudeOfLastPoint
                     && m_iScansNegatively == other.m_iScansNegatively
                     && m_jScansPositively == other.m_jScansPositively
-                    && m_numberOfPoints == other.m_numberOfPoints;
+                    && m_numberOfPoints == other.m_numberOfPoints
+                    && m_gridDefinition == other.m_gridDefinition;
+        }
+
+        // Every field is hashed so grids only collide by chance, the value is the same in every process
+        uint64_t stableHash() const
+        {
+            return StableHash().add(m_latitudeOfFirstPoint)
+                               .add(m_longitudeOfFirstPoint)
+                               .add(m_latitudeOfLastPoint)
+                               .add(m_longitudeOfLastPoint)
+                               .add((int64_t)m_iScansNegatively)
+                               .add((int64_t)m_jScansPositively)
+                               .add((int64_t)m_numberOfPoints)
+                               .add(m_gridDefinition)
+                               .value();
         }
       
 };
@@ -57,11 +78,7 @@ struct hash<GridArea>
 {
     size_t operator()(const GridArea& ga) const noexcept
     {
-
-        unsigned long long h = (ga.m_latitudeOfFirstPoint * ga.m_longitudeOfFirstPoint * ga.m_latitudeOfLastPoint 
-                * ga.m_longitudeOfLastPoint) + (ga.m_numberOfPoints * (ga.m_iScansNegatively == 0 ? 10 : ga.m_iScansNegatively)
-                * (ga.m_jScansPositively == 0 ? 10 : ga.m_jScansPositively)); 
-        return h;
+        return (size_t)ga.stableHash();
     }
 }; 
 
@@ -0,0 +1,21 @@
+#ifndef GRID_COORDINATES_H_INCLUDED
+#define GRID_COORDINATES_H_INCLUDED
+
+#include <memory>
+#include <arrow/api.h>
+#include <arrow/util/byte_size.h>
+
+// The latitude and longitude of every point of a grid in the order eccodes returns the values.
+// Every message on the same grid shares these arrays so they are only computed once.
+struct GridCoordinates
+{
+    std::shared_ptr<arrow::Array> latitudes;
+    std::shared_ptr<arrow::Array> longitudes;
+
+    uint64_t getSizeInBytes() const
+    {
+        return arrow::util::TotalBufferSize(*latitudes) + arrow::util::TotalBufferSize(*longitudes);
+    }
+};
+
+#endif /*GRID_COORDINATES_H_INCLUDED*/
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include "interpolation.hpp"
+
+namespace {
+
+    const double COORDINATE_TOLERANCE = 1e-6;
+
+    // The difference between two longitudes in the range (-180, 180]
+    double longitudeDifference(double from, double to) {
+        auto difference = std::fmod(to - from, 360.0);
+        if (difference > 180.0) {
+            difference -= 360.0;
+        } else if (difference <= -180.0) {
+            difference += 360.0;
+        }
+        return difference;
+    }
+
+    // The position of value between the first and second point clamped to [0, 1] so locations aren't extrapolated
+    double fraction(double value, double first, double second) {
+        if (std::abs(second - first) < COORDINATE_TOLERANCE) {
+            return 0.0;
+        }
+        return std::clamp((value - first) / (second - first), 0.0, 1.0);
+    }
+
+}
+
+void inverseDistanceWeights(const double* distances, size_t count, double* weights) {
+    for (size_t i = 0; i < count; i++) {
+        if (distances[i] < COORDINATE_TOLERANCE) {
+            std::fill(weights, weights + count, 0.0);
+            weights[i] = 1.0;
+            return;
+        }
+    }
+
+    double total = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        weights[i] = std::isnan(distances[i]) ? 0.0 : 1.0 / (distances[i] * distances[i]);
+        total += weights[i];
+    }
+    for (size_t i = 0; i < count; i++) {
+        weights[i] = total > 0.0 ? weights[i] / total : 0.0;
+    }
+}
+
+void bilinearWeights(double lat, double lon, const double* lats, const double* lons, const double* distances,
+                     size_t count, double* weights) {
+
+    if (count != 4) {
+        inverseDistanceWeights(distances, count, weights);
+        return;
+    }
+
+    //Order the points by latitude, the first two should be one row and the last two the other
+    std::array<size_t, 4> order;
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return lats[a] < lats[b]; });
+
+    auto a = order[0], b = order[1], c = order[2], d = order[3];
+    if (std::abs(lats[a] - lats[b]) > COORDINATE_TOLERANCE || std::abs(lats[c] - lats[d]) > COORDINATE_TOLERANCE) {
+        inverseDistanceWeights(distances, count, weights);
+        return;
+    }
+
+    //Linear along each row then between the rows
+    auto lowerRow = fraction(longitudeDifference(lons[a], lon), 0.0, longitudeDifference(lons[a], lons[b]));
+    auto upperRow = fraction(longitudeDifference(lons[c], lon), 0.0, longitudeDifference(lons[c], lons[d]));
+    auto betweenRows = fraction(lat, lats[a], lats[c]);
+
+    weights[a] = (1.0 - lowerRow) * (1.0 - betweenRows);
+    weights[b] = lowerRow * (1.0 - betweenRows);
+    weights[c] = (1.0 - upperRow) * betweenRows;
+    weights[d] = upperRow * betweenRows;
+}
+
+void applyWeights(const InterpolationWeights& weights, const double* stencilValues, size_t numberOfLocations,
+                  std::optional<double> missingValue, double* values) {
+
+    auto stencilSize = weights.stencilSize;
+    for (size_t i = 0; i < numberOfLocations; i++) {
+        auto first = i * stencilSize;
+        double total = 0.0;
+        double totalWeight = 0.0;
+        for (size_t n = first; n < first + stencilSize; n++) {
+            auto weight = weights.weights[n];
+            if (weight == 0.0 || (missingValue && stencilValues[n] == *missingValue)) {
+                continue;
+            }
+            total += weight * stencilValues[n];
+            totalWeight += weight;
+        }
+
+        if (totalWeight > 0.0) {
+            values[i] = total / totalWeight;
+        } else {
+            values[i] = missingValue.value_or(NAN);
+        }
+    }
+}
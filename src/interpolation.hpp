@@ -0,0 +1,36 @@
+#ifndef INTERPOLATION_H_INCLUDED
+#define INTERPOLATION_H_INCLUDED
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+// How the value at each location passed to withLocations is calculated
+// Nearest uses the nearest grid point, Bilinear the 4 surrounding points and InverseDistance the k nearest points
+enum class InterpolationMethod { Nearest, Bilinear, InverseDistance };
+
+// The grid points and weights used to calculate the value at each location.
+// Location i uses the stencilSize entries starting at i * stencilSize, unused entries have a weight of 0
+// These only depend on the grid so are calculated once and every message just gathers the values.
+struct InterpolationWeights
+{
+    size_t stencilSize;
+    std::vector<int> indexes;
+    std::vector<double> weights;
+};
+
+// Weights for the points surrounding a location returned by codes_grib_nearest_find (two points on each of two rows)
+// Falls back to inverse distance weights if the points don't form two rows
+void bilinearWeights(double lat, double lon, const double* lats, const double* lons, const double* distances,
+                     size_t count, double* weights);
+
+// Weights proportional to the inverse square of the distance, a point at the location gets all of the weight
+void inverseDistanceWeights(const double* distances, size_t count, double* weights);
+
+// Calculates the weighted sum of stencilValues (the value of every entry of the stencils) for each location.
+// Entries equal to missingValue are left out and the remaining weights rescaled, locations where
+// every entry is missing are set to missingValue.
+void applyWeights(const InterpolationWeights& weights, const double* stencilValues, size_t numberOfLocations,
+                  std::optional<double> missingValue, double* values);
+
+#endif /*INTERPOLATION_H_INCLUDED*/
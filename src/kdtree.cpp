@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <thread>
+#include "kdtree.hpp"
+
+namespace {
+
+    // The radius eccodes uses for the distances returned by grib_nearest_find_multiple
+    const double EARTH_RADIUS_KM = 6371.229;
+    // Ranges this small are searched linearly
+    const size_t LEAF_SIZE = 8;
+
+    std::array<double, 3> toUnitVector(double lat, double lon) {
+        auto phi = lat * M_PI / 180.0;
+        auto lambda = lon * M_PI / 180.0;
+        return {std::cos(phi) * std::cos(lambda), std::cos(phi) * std::sin(lambda), std::sin(phi)};
+    }
+
+    double squaredChord(const std::array<double, 3>& a, const std::array<double, 3>& b) {
+        auto dx = a[0] - b[0];
+        auto dy = a[1] - b[1];
+        auto dz = a[2] - b[2];
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    double chordToKm(double squaredChord) {
+        auto halfChord = std::min(1.0, std::sqrt(squaredChord) / 2.0);
+        return 2.0 * std::asin(halfChord) * EARTH_RADIUS_KM;
+    }
+
+}
+
+KdTree::KdTree(const double* lats, const double* lons, size_t numberOfPoints) :
+    points(numberOfPoints), indexes(numberOfPoints), axes(numberOfPoints, 0) {
+
+    for (size_t i = 0; i < numberOfPoints; i++) {
+        points[i] = toUnitVector(lats[i], lons[i]);
+        indexes[i] = (int)i;
+    }
+    build(0, numberOfPoints);
+}
+
+size_t KdTree::size() const {
+    return points.size();
+}
+
+void KdTree::build(size_t first, size_t last) {
+    if (last - first <= LEAF_SIZE) {
+        return;
+    }
+
+    //Split on the axis with the largest spread
+    std::array<double, 3> lower = points[first];
+    std::array<double, 3> upper = points[first];
+    for (size_t i = first + 1; i < last; i++) {
+        for (int d = 0; d < 3; d++) {
+            lower[d] = std::min(lower[d], points[i][d]);
+            upper[d] = std::max(upper[d], points[i][d]);
+        }
+    }
+    unsigned char axis = 0;
+    for (unsigned char d = 1; d < 3; d++) {
+        if (upper[d] - lower[d] > upper[axis] - lower[axis]) {
+            axis = d;
+        }
+    }
+
+    //Points and indexes are reordered together so sort the positions first
+    size_t middle = first + (last - first) / 2;
+    std::vector<size_t> order(last - first);
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = first + i;
+    }
+    std::nth_element(order.begin(), order.begin() + (middle - first), order.end(),
+                     [&](size_t a, size_t b) { return points[a][axis] < points[b][axis]; });
+
+    std::vector<std::array<double, 3>> sortedPoints(order.size());
+    std::vector<int> sortedIndexes(order.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        sortedPoints[i] = points[order[i]];
+        sortedIndexes[i] = indexes[order[i]];
+    }
+    std::copy(sortedPoints.begin(), sortedPoints.end(), points.begin() + first);
+    std::copy(sortedIndexes.begin(), sortedIndexes.end(), indexes.begin() + first);
+
+    axes[middle] = axis;
+    build(first, middle);
+    build(middle + 1, last);
+}
+
+void KdTree::search(size_t first, size_t last, const std::array<double, 3>& target, size_t k,
+                    std::vector<std::pair<double, int>>& heap) const {
+
+    //heap is a max heap of the k nearest points found so far
+    auto consider = [&](size_t position) {
+        auto distance = squaredChord(points[position], target);
+        if (heap.size() < k) {
+            heap.emplace_back(distance, indexes[position]);
+            std::push_heap(heap.begin(), heap.end());
+        } else if (distance < heap.front().first) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.back() = {distance, indexes[position]};
+            std::push_heap(heap.begin(), heap.end());
+        }
+    };
+
+    if (last - first <= LEAF_SIZE) {
+        for (size_t i = first; i < last; i++) {
+            consider(i);
+        }
+        return;
+    }
+
+    size_t middle = first + (last - first) / 2;
+    consider(middle);
+
+    auto axis = axes[middle];
+    auto difference = target[axis] - points[middle][axis];
+    if (difference < 0) {
+        search(first, middle, target, k, heap);
+        if (heap.size() < k || difference * difference < heap.front().first) {
+            search(middle + 1, last, target, k, heap);
+        }
+    } else {
+        search(middle + 1, last, target, k, heap);
+        if (heap.size() < k || difference * difference < heap.front().first) {
+            search(first, middle, target, k, heap);
+        }
+    }
+}
+
+std::vector<KdTree::Neighbour> KdTree::nearest(double lat, double lon, size_t k) const {
+    std::vector<std::pair<double, int>> heap;
+    heap.reserve(k);
+    search(0, points.size(), toUnitVector(lat, lon), k, heap);
+
+    std::sort_heap(heap.begin(), heap.end());
+    std::vector<Neighbour> neighbours;
+    neighbours.reserve(heap.size());
+    for (auto& entry : heap) {
+        neighbours.push_back({entry.second, chordToKm(entry.first)});
+    }
+    return neighbours;
+}
+
+void KdTree::nearest(const double* lats, const double* lons, size_t numberOfLocations, unsigned int numberOfThreads,
+                     int* indexes, double* distances, size_t k) const {
+
+    auto searchBlock = [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            auto neighbours = nearest(lats[i], lons[i], k);
+            //A grid with fewer than k points has no more neighbours
+            for (size_t n = 0; n < k; n++) {
+                indexes[i * k + n] = n < neighbours.size() ? neighbours[n].index : -1;
+                distances[i * k + n] = n < neighbours.size() ? neighbours[n].distance : NAN;
+            }
+        }
+    };
+
+    size_t threads = std::max((size_t)1, std::min((size_t)numberOfThreads, numberOfLocations));
+    if (threads == 1) {
+        searchBlock(0, numberOfLocations);
+        return;
+    }
+
+    //Every thread searches a contiguous block of locations
+    size_t blockSize = (numberOfLocations + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    std::vector<std::exception_ptr> errors(threads);
+    for (size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            try {
+                searchBlock(t * blockSize, std::min(numberOfLocations, (t + 1) * blockSize));
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef KD_TREE_H_INCLUDED
+#define KD_TREE_H_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+// How withLocations finds the grid point nearest to each location
+// Eccodes uses grib_nearest_find_multiple, KdTree searches a tree built from the coordinates of the grid and
+// Projection projects the location onto regular, rotated and lambert grids (other grids use eccodes)
+enum class NearestMethod { Eccodes, KdTree, Projection };
+
+// A kd-tree over the points of a grid. The points are stored as unit vectors so the search
+// doesn't have to deal with the dateline or the poles and the nearest point by straight line
+// distance is also the nearest point on the sphere.
+class KdTree
+{
+public:
+    struct Neighbour
+    {
+        int index;
+        // Great circle distance in km (the same earth radius as eccodes)
+        double distance;
+    };
+
+    KdTree(const double* lats, const double* lons, size_t numberOfPoints);
+
+    // The k nearest points to the location, nearest first
+    std::vector<Neighbour> nearest(double lat, double lon, size_t k = 1) const;
+
+    // Finds the k nearest points to every location, the locations are split into blocks searched on separate threads
+    // indexes and distances hold k entries per location, nearest first
+    void nearest(const double* lats, const double* lons, size_t numberOfLocations, unsigned int numberOfThreads,
+                 int* indexes, double* distances, size_t k = 1) const;
+
+    size_t size() const;
+
+private:
+    // The points in tree order, the median of each range is the node splitting it
+    std::vector<std::array<double, 3>> points;
+    // The index of each point in the grid
+    std::vector<int> indexes;
+    // The axis the node at each position splits on
+    std::vector<unsigned char> axes;
+
+    void build(size_t first, size_t last);
+    void search(size_t first, size_t last, const std::array<double, 3>& target, size_t k,
+                std::vector<std::pair<double, int>>& heap) const;
+};
+
+#endif /*KD_TREE_H_INCLUDED*/
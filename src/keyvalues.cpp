@@ -0,0 +1,136 @@
+#include <sstream>
+#include "keyvalues.hpp"
+
+namespace {
+
+    std::string toString(const KeyValue& value) {
+        if (auto longValue = std::get_if<long>(&value)) {
+            return std::to_string(*longValue);
+        }
+        if (auto doubleValue = std::get_if<double>(&value)) {
+            std::ostringstream oss;
+            oss << *doubleValue;
+            return oss.str();
+        }
+        return std::get<std::string>(value);
+    }
+
+    template <typename T, typename Builder>
+    arrow::Result<std::shared_ptr<arrow::Array>> buildColumn(const std::vector<KeyValue>& values, Builder& builder) {
+        ARROW_RETURN_NOT_OK(builder.Reserve(values.size()));
+        for (auto& value : values) {
+            if (std::holds_alternative<std::monostate>(value)) {
+                ARROW_RETURN_NOT_OK(builder.AppendNull());
+            } else {
+                ARROW_RETURN_NOT_OK(builder.Append(std::get<T>(value)));
+            }
+        }
+        return builder.Finish();
+    }
+}
+
+int getNativeKeyType(codes_handle* h, const std::string& key) {
+    int nativeType = CODES_TYPE_UNDEFINED;
+    if (codes_get_native_type(h, key.c_str(), &nativeType) != 0) {
+        return CODES_TYPE_UNDEFINED;
+    }
+    return nativeType;
+}
+
+KeyValue readKey(codes_handle* h, const std::string& key, int nativeType) {
+
+    switch (nativeType) {
+        case CODES_TYPE_LONG: {
+            long value;
+            if (codes_get_long(h, key.c_str(), &value) != 0) {
+                return std::monostate();
+            }
+            return value;
+        }
+        case CODES_TYPE_DOUBLE: {
+            double value;
+            if (codes_get_double(h, key.c_str(), &value) != 0) {
+                return std::monostate();
+            }
+            return value;
+        }
+        case CODES_TYPE_STRING: {
+            char value[1024];
+            size_t length = sizeof(value);
+            if (codes_get_string(h, key.c_str(), value, &length) != 0) {
+                return std::monostate();
+            }
+            return std::string(value);
+        }
+        default:
+            return std::monostate();
+    }
+}
+
+KeyValue readKey(codes_handle* h, const std::string& key) {
+    return readKey(h, key, getNativeKeyType(h, key));
+}
+
+std::shared_ptr<arrow::DataType> keyTypeToArrow(int nativeType) {
+    switch (nativeType) {
+        case CODES_TYPE_LONG:
+            return arrow::int64();
+        case CODES_TYPE_DOUBLE:
+            return arrow::float64();
+        default:
+            return arrow::utf8();
+    }
+}
+
+arrow::Result<std::shared_ptr<arrow::Array>> keyValuesToArrow(const std::vector<KeyValue>& values) {
+
+    //The first message which has the key decides the type
+    size_t typeIndex = 0;
+    bool mixedTypes = false;
+    for (auto& value : values) {
+        if (std::holds_alternative<std::monostate>(value)) {
+            continue;
+        }
+        if (typeIndex == 0) {
+            typeIndex = value.index();
+        } else if (typeIndex != value.index()) {
+            mixedTypes = true;
+        }
+    }
+
+    if (mixedTypes) {
+        std::vector<KeyValue> strings;
+        strings.reserve(values.size());
+        for (auto& value : values) {
+            strings.push_back(std::holds_alternative<std::monostate>(value) ? value : KeyValue(toString(value)));
+        }
+        arrow::StringBuilder builder;
+        return buildColumn<std::string>(strings, builder);
+    }
+
+    if (typeIndex == 1) {
+        arrow::Int64Builder builder;
+        return buildColumn<long>(values, builder);
+    }
+    if (typeIndex == 2) {
+        arrow::DoubleBuilder builder;
+        return buildColumn<double>(values, builder);
+    }
+    //Strings, or a key no message has which is left as a column of nulls
+    arrow::StringBuilder builder;
+    return buildColumn<std::string>(values, builder);
+}
+
+std::optional<int> KeyTypeCache::find(const std::string& definition, const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto match = nativeTypes.find({definition, key});
+    if (match == nativeTypes.end()) {
+        return std::nullopt;
+    }
+    return match->second;
+}
+
+void KeyTypeCache::add(const std::string& definition, const std::string& key, int nativeType) {
+    std::lock_guard<std::mutex> lock(mutex);
+    nativeTypes.emplace(std::make_pair(definition, key), nativeType);
+}
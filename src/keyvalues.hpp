@@ -0,0 +1,51 @@
+#ifndef KEY_VALUES_H_INCLUDED
+#define KEY_VALUES_H_INCLUDED
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+#include <arrow/api.h>
+#include "eccodes.h"
+
+// The value of a header key read using the native type of the key
+// monostate means the message doesn't have the key (or its value is missing)
+using KeyValue = std::variant<std::monostate, long, double, std::string>;
+
+// Returns the eccodes type of the key (CODES_TYPE_LONG, CODES_TYPE_DOUBLE, CODES_TYPE_STRING)
+// or CODES_TYPE_UNDEFINED when the message doesn't have the key
+int getNativeKeyType(codes_handle* h, const std::string& key);
+
+// Reads the key as the given eccodes type, a single call to eccodes
+KeyValue readKey(codes_handle* h, const std::string& key, int nativeType);
+
+// Reads the key using its native type
+KeyValue readKey(codes_handle* h, const std::string& key);
+
+// The arrow type which holds the values of a key with the given eccodes type
+std::shared_ptr<arrow::DataType> keyTypeToArrow(int nativeType);
+
+// Builds a column from the values of one key across many messages.
+// The type of the column is that of the values, if the messages disagree the values are converted to strings.
+arrow::Result<std::shared_ptr<arrow::Array>> keyValuesToArrow(const std::vector<KeyValue>& values);
+
+// The native type of keys per grid / product definition.
+// Messages with the same definitions have keys of the same type so the type only needs to be looked up once.
+// Shared by every thread decoding messages of a reader.
+class KeyTypeCache
+{
+
+    public:
+
+        std::optional<int> find(const std::string& definition, const std::string& key);
+        void add(const std::string& definition, const std::string& key, int nativeType);
+
+    private:
+
+        std::mutex mutex;
+        std::map<std::pair<std::string, std::string>, int> nativeTypes;
+};
+
+#endif /* KEY_VALUES_H_INCLUDED */
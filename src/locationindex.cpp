@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cmath>
+#include "locationindex.hpp"
+#include "exceptions/arrowgenericexception.hpp"
+
+namespace {
+
+    const double MAX_BUCKETS_PER_AXIS = 4096;
+
+    // The values of a chunked double column with NAN for nulls
+    std::vector<double> toValues(std::shared_ptr<arrow::ChunkedArray> column) {
+        std::vector<double> values;
+        values.reserve(column->length());
+        for (auto& chunk : column->chunks()) {
+            auto doubles = std::static_pointer_cast<arrow::DoubleArray>(chunk);
+            for (int64_t i = 0; i < doubles->length(); i++) {
+                values.push_back(doubles->IsNull(i) ? NAN : doubles->Value(i));
+            }
+        }
+        return values;
+    }
+
+}
+
+LocationIndex::LocationIndex(std::shared_ptr<arrow::ChunkedArray> lats, std::shared_ptr<arrow::ChunkedArray> lons,
+                             double bucketSize) : bucketSize(bucketSize) {
+
+    auto latValues = toValues(lats);
+    auto lonValues = toValues(lons);
+    numberOfRows = latValues.size();
+
+    std::vector<int64_t> indexed;
+    double lastLat = 0, lastLon = 0;
+    for (int64_t i = 0; i < numberOfRows; i++) {
+        if (std::isnan(latValues[i]) || std::isnan(lonValues[i])) {
+            continue;
+        }
+        if (indexed.empty()) {
+            firstLat = lastLat = latValues[i];
+            firstLon = lastLon = lonValues[i];
+        }
+        firstLat = std::min(firstLat, latValues[i]);
+        lastLat = std::max(lastLat, latValues[i]);
+        firstLon = std::min(firstLon, lonValues[i]);
+        lastLon = std::max(lastLon, lonValues[i]);
+        indexed.push_back(i);
+    }
+
+    //Keep the number of buckets bounded when the locations are spread over a large range
+    bucketSize = std::max(bucketSize, std::max(lastLat - firstLat, lastLon - firstLon) / MAX_BUCKETS_PER_AXIS);
+    latBuckets = indexed.empty() ? 0 : latBucket(lastLat) + 1;
+    lonBuckets = indexed.empty() ? 0 : lonBucket(lastLon) + 1;
+
+    //Count the rows in each bucket then place them, the rows of a bucket stay in table order
+    offsets.assign(latBuckets * lonBuckets + 1, 0);
+    for (auto row : indexed) {
+        offsets[latBucket(latValues[row]) * lonBuckets + lonBucket(lonValues[row]) + 1]++;
+    }
+    for (size_t b = 1; b < offsets.size(); b++) {
+        offsets[b] += offsets[b - 1];
+    }
+
+    rows.resize(indexed.size());
+    rowLats.resize(indexed.size());
+    rowLons.resize(indexed.size());
+    std::vector<int64_t> next(offsets.begin(), offsets.end() - 1);
+    for (auto row : indexed) {
+        auto position = next[latBucket(latValues[row]) * lonBuckets + lonBucket(lonValues[row])]++;
+        rows[position] = row;
+        rowLats[position] = latValues[row];
+        rowLons[position] = lonValues[row];
+    }
+}
+
+int64_t LocationIndex::size() const {
+    return numberOfRows;
+}
+
+int64_t LocationIndex::latBucket(double lat) const {
+    return std::clamp((int64_t)std::floor((lat - firstLat) / bucketSize), (int64_t)0, std::max(latBuckets - 1, (int64_t)0));
+}
+
+int64_t LocationIndex::lonBucket(double lon) const {
+    return std::clamp((int64_t)std::floor((lon - firstLon) / bucketSize), (int64_t)0, std::max(lonBuckets - 1, (int64_t)0));
+}
+
+std::shared_ptr<arrow::Int64Array> LocationIndex::select(double minLat, double maxLat, double minLon, double maxLon,
+                                                         const std::function<bool(double lat, double lon)>& accept) const {
+    std::vector<int64_t> selected;
+
+    if (!rows.empty() && minLat <= maxLat && minLon <= maxLon) {
+        auto firstLatBucket = latBucket(minLat), lastLatBucket = latBucket(maxLat);
+        auto firstLonBucket = lonBucket(minLon), lastLonBucket = lonBucket(maxLon);
+
+        for (auto latB = firstLatBucket; latB <= lastLatBucket; latB++) {
+            for (auto lonB = firstLonBucket; lonB <= lastLonBucket; lonB++) {
+                auto bucket = latB * lonBuckets + lonB;
+                for (auto position = offsets[bucket]; position < offsets[bucket + 1]; position++) {
+                    if (rowLats[position] >= minLat && rowLats[position] <= maxLat
+                        && rowLons[position] >= minLon && rowLons[position] <= maxLon
+                        && (!accept || accept(rowLats[position], rowLons[position]))) {
+                        selected.push_back(rows[position]);
+                    }
+                }
+            }
+        }
+        std::sort(selected.begin(), selected.end());
+    }
+
+    arrow::Int64Builder builder;
+    auto status = builder.AppendValues(selected);
+    std::shared_ptr<arrow::Int64Array> result;
+    if (status.ok()) {
+        status = builder.Finish(&result);
+    }
+    if (!status.ok()) {
+        throw ArrowGenericException("Unable to build the selected locations " + status.message());
+    }
+    return result;
+}
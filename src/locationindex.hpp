@@ -0,0 +1,44 @@
+#ifndef LOCATION_INDEX_H_INCLUDED
+#define LOCATION_INDEX_H_INCLUDED
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <arrow/api.h>
+
+// Buckets the rows of the locations table by latitude and longitude so the locations within the area of a grid
+// can be found without scanning the whole table. Built once by withLocations.
+class LocationIndex
+{
+public:
+    // lats and lons are the lat and lon columns of the locations table, rows with a null coordinate are never selected
+    LocationIndex(std::shared_ptr<arrow::ChunkedArray> lats, std::shared_ptr<arrow::ChunkedArray> lons,
+                  double bucketSize = 1.0);
+
+    // The rows where minLat <= lat <= maxLat and minLon <= lon <= maxLon in the order of the table
+    // accept is called for the rows within the bounds and further restricts the rows selected e.g. to a projected grid
+    std::shared_ptr<arrow::Int64Array> select(double minLat, double maxLat, double minLon, double maxLon,
+                                              const std::function<bool(double lat, double lon)>& accept = nullptr) const;
+
+    int64_t size() const;
+
+private:
+    double bucketSize;
+    double firstLat = 0;
+    double firstLon = 0;
+    int64_t latBuckets = 0;
+    int64_t lonBuckets = 0;
+    int64_t numberOfRows = 0;
+    // The rows of bucket b are rows[offsets[b]] to rows[offsets[b + 1] - 1]
+    std::vector<int64_t> offsets;
+    std::vector<int64_t> rows;
+    // The coordinates of the rows in the same order as rows so the edge buckets can be checked without the table
+    std::vector<double> rowLats;
+    std::vector<double> rowLons;
+
+    int64_t latBucket(double lat) const;
+    int64_t lonBucket(double lon) const;
+};
+
+#endif /*LOCATION_INDEX_H_INCLUDED*/
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/api.h>
+#include "locationstore.hpp"
+
+namespace {
+
+    const std::string storeVersion = "1";
+    const std::string versionKey = "gribtoarrow.location_store_version";
+
+    arrow::FieldVector getStoreFields(size_t stencilSize) {
+        arrow::FieldVector fields = {
+            arrow::field("index", arrow::int32()),
+            arrow::field("distance", arrow::float64()),
+            arrow::field("nearestlatitude", arrow::float64()),
+            arrow::field("nearestlongitude", arrow::float64())
+        };
+        if (stencilSize > 0) {
+            fields.push_back(arrow::field("stencil_index", arrow::fixed_size_list(arrow::int32(), stencilSize)));
+            fields.push_back(arrow::field("stencil_weight", arrow::fixed_size_list(arrow::float64(), stencilSize)));
+        }
+        return fields;
+    }
+
+    arrow::Result<std::shared_ptr<arrow::RecordBatch>> toRecordBatch(long numberOfPoints, const StoredLocationData& data) {
+        auto weights = data.interpolationWeights;
+        auto stencilSize = weights ? weights->stencilSize : 0;
+
+        arrow::ArrayVector columns = {
+            std::make_shared<arrow::Int32Array>(numberOfPoints, data.indexes),
+            data.distances,
+            data.outlats,
+            data.outlons
+        };
+        if (weights) {
+            auto stencilIndexes = std::make_shared<arrow::Int32Array>(weights->indexes.size(), arrow::Buffer::Wrap(weights->indexes));
+            auto stencilWeights = std::make_shared<arrow::DoubleArray>(weights->weights.size(), arrow::Buffer::Wrap(weights->weights));
+            ARROW_ASSIGN_OR_RAISE(auto indexColumn, arrow::FixedSizeListArray::FromArrays(stencilIndexes, stencilSize));
+            ARROW_ASSIGN_OR_RAISE(auto weightColumn, arrow::FixedSizeListArray::FromArrays(stencilWeights, stencilSize));
+            columns.push_back(indexColumn);
+            columns.push_back(weightColumn);
+        }
+        auto metadata = arrow::key_value_metadata({versionKey}, {storeVersion});
+        return arrow::RecordBatch::Make(arrow::schema(getStoreFields(stencilSize), metadata), numberOfPoints, columns);
+    }
+
+    //A file matched to a different grid (or a corrupt one) mustn't be used to read outside the values of the grid
+    bool indexesInGrid(const int32_t* indexes, int64_t length, long numberOfGridPoints) {
+        return std::all_of(indexes, indexes + length, [numberOfGridPoints](int32_t index) {
+            return index >= 0 && index < numberOfGridPoints;
+        });
+    }
+
+    arrow::Result<StoredLocationData> fromRecordBatch(std::shared_ptr<arrow::RecordBatch> batch, long numberOfPoints, long numberOfGridPoints) {
+        auto metadata = batch->schema()->metadata();
+        if (metadata == nullptr || metadata->FindKey(versionKey) < 0 || metadata->value(metadata->FindKey(versionKey)) != storeVersion) {
+            return arrow::Status::Invalid("Stored locations were written by a different version");
+        }
+        if (batch->num_rows() != numberOfPoints) {
+            return arrow::Status::Invalid("Stored locations have a different number of rows");
+        }
+
+        size_t stencilSize = 0;
+        if (batch->num_columns() == 6) {
+            stencilSize = std::static_pointer_cast<arrow::FixedSizeListType>(batch->column(4)->type())->list_size();
+        }
+        if (!batch->schema()->Equals(*arrow::schema(getStoreFields(stencilSize)), false)) {
+            return arrow::Status::Invalid("Stored locations have an unexpected schema");
+        }
+
+        auto indexArray = std::static_pointer_cast<arrow::Int32Array>(batch->column(0));
+        if (indexArray->null_count() > 0 || !indexesInGrid(indexArray->raw_values(), indexArray->length(), numberOfGridPoints)) {
+            return arrow::Status::Invalid("Stored locations have an index outside the grid");
+        }
+
+        //The arrays (and the index buffer) reference the memory mapped file rather than a copy of it
+        auto indexes = indexArray->data();
+        StoredLocationData data {arrow::SliceBuffer(indexes->buffers[1], indexes->offset * sizeof(int32_t), numberOfPoints * sizeof(int32_t)),
+                                 batch->column(1),
+                                 batch->column(2),
+                                 batch->column(3),
+                                 nullptr};
+
+        if (stencilSize > 0) {
+            auto stencilIndexes = std::static_pointer_cast<arrow::Int32Array>(
+                std::static_pointer_cast<arrow::FixedSizeListArray>(batch->column(4))->Flatten().ValueOrDie());
+            auto stencilWeights = std::static_pointer_cast<arrow::DoubleArray>(
+                std::static_pointer_cast<arrow::FixedSizeListArray>(batch->column(5))->Flatten().ValueOrDie());
+            if (stencilIndexes->length() != numberOfPoints * (int64_t)stencilSize || stencilWeights->length() != stencilIndexes->length()
+                || !indexesInGrid(stencilIndexes->raw_values(), stencilIndexes->length(), numberOfGridPoints)) {
+                return arrow::Status::Invalid("Stored locations have a stencil outside the grid");
+            }
+            //Unlike the other columns the stencils are copied out of the file, InterpolationWeights owns its vectors
+            data.interpolationWeights = std::make_shared<InterpolationWeights>(InterpolationWeights {
+                stencilSize,
+                std::vector<int>(stencilIndexes->raw_values(), stencilIndexes->raw_values() + stencilIndexes->length()),
+                std::vector<double>(stencilWeights->raw_values(), stencilWeights->raw_values() + stencilWeights->length())
+            });
+        }
+        return data;
+    }
+
+    arrow::Result<std::shared_ptr<arrow::RecordBatch>> readStoreFile(std::string path) {
+        ARROW_ASSIGN_OR_RAISE(auto file, arrow::io::MemoryMappedFile::Open(path, arrow::io::FileMode::READ));
+        ARROW_ASSIGN_OR_RAISE(auto reader, arrow::ipc::RecordBatchFileReader::Open(file));
+        if (reader->num_record_batches() != 1) {
+            return arrow::Status::Invalid("Stored locations should have a single record batch");
+        }
+        ARROW_ASSIGN_OR_RAISE(auto batch, reader->ReadRecordBatch(0));
+        return batch->ReplaceSchemaMetadata(reader->schema()->metadata());
+    }
+
+    arrow::Status writeStoreFile(std::shared_ptr<arrow::RecordBatch> batch, std::string path) {
+        ARROW_ASSIGN_OR_RAISE(auto file, arrow::io::FileOutputStream::Open(path));
+        ARROW_ASSIGN_OR_RAISE(auto writer, arrow::ipc::MakeFileWriter(file, batch->schema()));
+        ARROW_RETURN_NOT_OK(writer->WriteRecordBatch(*batch));
+        ARROW_RETURN_NOT_OK(writer->Close());
+        return file->Close();
+    }
+}
+
+LocationStore::LocationStore(std::string directory) : directory(directory) {}
+
+std::string LocationStore::getDirectory() const {
+    return directory;
+}
+
+std::string LocationStore::getPath(const std::string& key) const {
+    return directory + "/" + key + ".arrow";
+}
+
+std::optional<StoredLocationData> LocationStore::load(const std::string& key, long numberOfPoints, long numberOfGridPoints) const {
+    auto path = getPath(key);
+    if (access(path.c_str(), R_OK) != 0) {
+        return std::nullopt;
+    }
+
+    auto batch = readStoreFile(path);
+    if (!batch.ok()) {
+        std::cout << "Not using stored locations " << path << " " << batch.status().message() << std::endl;
+        return std::nullopt;
+    }
+    auto data = fromRecordBatch(batch.ValueOrDie(), numberOfPoints, numberOfGridPoints);
+    if (!data.ok()) {
+        std::cout << "Not using stored locations " << path << " " << data.status().message() << std::endl;
+        return std::nullopt;
+    }
+    return data.MoveValueUnsafe();
+}
+
+void LocationStore::save(const std::string& key, long numberOfPoints, const StoredLocationData& data) const {
+    auto path = getPath(key);
+    auto batch = toRecordBatch(numberOfPoints, data);
+
+    //Written under a temporary name then renamed so another process never maps a partly written file
+    std::ostringstream temporaryPath;
+    temporaryPath << path << "." << getpid() << ".tmp";
+
+    //The store is only an optimisation so a read only directory shouldn't stop the grib being read
+    auto status = batch.ok() ? writeStoreFile(batch.ValueOrDie(), temporaryPath.str()) : batch.status();
+    if (status.ok() && std::rename(temporaryPath.str().c_str(), path.c_str()) != 0) {
+        status = arrow::Status::IOError("Unable to rename ", temporaryPath.str());
+    }
+    if (!status.ok()) {
+        std::remove(temporaryPath.str().c_str());
+        std::cout << "Unable to save locations " << path << " " << status.message() << std::endl;
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef LOCATION_STORE_H_INCLUDED
+#define LOCATION_STORE_H_INCLUDED
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <arrow/api.h>
+#include "interpolation.hpp"
+#include "stablehash.hpp"
+
+// The result of matching a set of locations to a grid, everything in GribLocationData which depends on the grid
+struct StoredLocationData {
+    // The index of the nearest grid point of each location (int values)
+    std::shared_ptr<arrow::Buffer> indexes;
+    // float64 arrays
+    std::shared_ptr<arrow::Array> distances;
+    std::shared_ptr<arrow::Array> outlats;
+    std::shared_ptr<arrow::Array> outlons;
+    // nullptr when the value of the nearest point is used
+    std::shared_ptr<InterpolationWeights> interpolationWeights;
+};
+
+// A directory of arrow IPC files holding the locations matched to each grid so other readers (and other processes)
+// don't have to search the grid again. Each file is named after a hash of the grid definition, the coordinates of the
+// locations and the settings used to match them. Files are memory mapped when they are loaded so the arrays
+// returned point straight at the file, apart from the interpolation stencils which are copied into InterpolationWeights.
+class LocationStore
+{
+
+    public:
+
+        LocationStore(std::string directory);
+
+        // numberOfPoints is the number of locations, a file with an index outside the numberOfGridPoints of the grid is ignored
+        std::optional<StoredLocationData> load(const std::string& key, long numberOfPoints, long numberOfGridPoints) const;
+        void save(const std::string& key, long numberOfPoints, const StoredLocationData& data) const;
+
+        std::string getDirectory() const;
+
+    private:
+
+        std::string directory;
+        std::string getPath(const std::string& key) const;
+};
+
+#endif /*LOCATION_STORE_H_INCLUDED*/
@@ -0,0 +1,119 @@
+#ifndef LRU_CACHE_H_INCLUDED
+#define LRU_CACHE_H_INCLUDED
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+// The counters of a cache, hits and misses are counted by get and evictions by put
+struct CacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t entries = 0;
+    uint64_t bytes = 0;
+    uint64_t capacityBytes = 0;
+};
+
+// A cache which evicts the least recently used entries once the entries use more than capacityBytes.
+// The cache owns the entries, callers share ownership so an evicted entry stays valid while it is being used.
+// The most recently added entry is always kept even if it is larger than the capacity.
+template <typename Key, typename Value>
+class LruCache
+{
+    public:
+
+        LruCache(uint64_t capacityBytes) : capacityBytes(capacityBytes) {}
+
+        std::shared_ptr<Value> get(const Key& key) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = entries.find(key);
+            if (found == entries.end()) {
+                misses++;
+                return nullptr;
+            }
+            hits++;
+            order.splice(order.begin(), order, found->second);
+            return found->second->value;
+        }
+
+        // Returns the entry already in the cache if another caller added the key first
+        std::shared_ptr<Value> put(const Key& key, std::shared_ptr<Value> value, uint64_t bytes) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (auto found = entries.find(key); found != entries.end()) {
+                order.splice(order.begin(), order, found->second);
+                return found->second->value;
+            }
+
+            order.push_front(Entry {key, value, bytes});
+            entries.emplace(key, order.begin());
+            usedBytes += bytes;
+            evict();
+            return value;
+        }
+
+        // Updates the bytes of an entry which has grown since it was added, an entry which was replaced or evicted is left alone
+        void resize(const Key& key, const std::shared_ptr<Value>& value, uint64_t bytes) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = entries.find(key);
+            if (found == entries.end() || found->second->value != value) {
+                return;
+            }
+            usedBytes = usedBytes - found->second->bytes + bytes;
+            found->second->bytes = bytes;
+            evict();
+        }
+
+        void clear() {
+            std::lock_guard<std::mutex> lock(mutex);
+            entries.clear();
+            order.clear();
+            usedBytes = 0;
+        }
+
+        void setCapacity(uint64_t capacityBytes) {
+            std::lock_guard<std::mutex> lock(mutex);
+            this->capacityBytes = capacityBytes;
+            evict();
+        }
+
+        CacheStats getStats() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return CacheStats {hits, misses, evictions, (uint64_t)entries.size(), usedBytes, capacityBytes};
+        }
+
+    private:
+
+        struct Entry
+        {
+            Key key;
+            std::shared_ptr<Value> value;
+            uint64_t bytes;
+        };
+
+        std::mutex mutex;
+        uint64_t capacityBytes;
+        uint64_t usedBytes = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        // Most recently used first
+        std::list<Entry> order;
+        std::unordered_map<Key, typename std::list<Entry>::iterator> entries;
+
+        void evict() {
+            while (usedBytes > capacityBytes && order.size() > 1) {
+                auto& last = order.back();
+                usedBytes -= last.bytes;
+                entries.erase(last.key);
+                order.pop_back();
+                evictions++;
+            }
+        }
+};
+
+#endif /*LRU_CACHE_H_INCLUDED*/
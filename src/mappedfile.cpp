@@ -0,0 +1,54 @@
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mappedfile.hpp"
+#include "exceptions/nosuchgribfileexception.hpp"
+#include "exceptions/gribexception.hpp"
+
+MappedFile::MappedFile(std::string filepath) {
+
+    auto fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw NoSuchGribFileException(filepath);
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0) {
+        close(fd);
+        throw GribException("Unable to get the size of file " + filepath);
+    }
+    m_size = (size_t)fileStat.st_size;
+
+    //mmap doesn't allow a zero length mapping - an empty file simply has no messages
+    if (m_size > 0) {
+        auto mapped = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            std::ostringstream oss;
+            oss << "Unable to memory map " << m_size << " bytes of file " << filepath;
+            throw GribException(oss.str());
+        }
+        m_data = (unsigned char*)mapped;
+        //Messages are mostly read from the start of the file to the end
+        posix_madvise(m_data, m_size, POSIX_MADV_SEQUENTIAL);
+    }
+
+    //The mapping stays valid after the descriptor is closed
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (m_data != nullptr) {
+        munmap(m_data, m_size);
+    }
+}
+
+const unsigned char* MappedFile::data() const {
+    return m_data;
+}
+
+size_t MappedFile::size() const {
+    return m_size;
+}
@@ -0,0 +1,31 @@
+#ifndef MAPPED_FILE_H_INCLUDED
+#define MAPPED_FILE_H_INCLUDED
+
+#include <cstddef>
+#include <string>
+
+// A read only memory mapping of a whole file.
+// The mapping is released when the object is destroyed so anything holding
+// pointers into it (e.g. codes handles created without copying the message)
+// must not outlive it.
+class MappedFile
+{
+
+    public:
+
+        MappedFile(std::string filepath);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const unsigned char* data() const;
+        size_t size() const;
+
+    private:
+
+        unsigned char* m_data = nullptr;
+        size_t m_size = 0;
+};
+
+#endif /* MAPPED_FILE_H_INCLUDED */
@@ -0,0 +1,115 @@
+#include "messagefilter.hpp"
+
+namespace {
+
+    // nullptr if the key isn't held in the index, the value is nullopt if the message doesn't have the key
+    const std::optional<long>* getIndexedLong(const MessageIndexEntry& entry, const std::string& key) {
+        if (key == "paramId") return &entry.parameterId;
+        if (key == "level") return &entry.level;
+        if (key == "step") return &entry.step;
+        if (key == "number") return &entry.number;
+        if (key == "date") return &entry.date;
+        if (key == "time") return &entry.time;
+        if (key == "editionNumber") return &entry.editionNumber;
+        return nullptr;
+    }
+
+    const std::optional<std::string>* getIndexedString(const MessageIndexEntry& entry, const std::string& key) {
+        if (key == "shortName") return &entry.shortName;
+        if (key == "typeOfLevel") return &entry.typeOfLevel;
+        return nullptr;
+    }
+
+}
+
+bool KeyPredicate::matches(codes_handle* h) const {
+    switch (type) {
+        case Type::LongIn: {
+            long value;
+            return codes_get_long(h, key.c_str(), &value) == 0 && longValues.count(value) > 0;
+        }
+        case Type::StringIn: {
+            char value[256];
+            size_t length = sizeof(value);
+            return codes_get_string(h, key.c_str(), value, &length) == 0 && stringValues.count(value) > 0;
+        }
+        case Type::Between: {
+            double value;
+            return codes_get_double(h, key.c_str(), &value) == 0 && value >= minimum && value <= maximum;
+        }
+    }
+    return false;
+}
+
+std::optional<bool> KeyPredicate::matches(const MessageIndexEntry& entry) const {
+    //A message without the key never matches, as with the handle
+    switch (type) {
+        case Type::LongIn: {
+            auto value = getIndexedLong(entry, key);
+            if (value == nullptr) {
+                return std::nullopt;
+            }
+            return value->has_value() && longValues.count(value->value()) > 0;
+        }
+        case Type::StringIn: {
+            auto value = getIndexedString(entry, key);
+            if (value == nullptr) {
+                return std::nullopt;
+            }
+            return value->has_value() && stringValues.count(value->value()) > 0;
+        }
+        case Type::Between: {
+            auto value = getIndexedLong(entry, key);
+            if (value == nullptr) {
+                return std::nullopt;
+            }
+            return value->has_value() && value->value() >= minimum && value->value() <= maximum;
+        }
+    }
+    return std::nullopt;
+}
+
+void MessageFilter::addKeyIn(std::string key, std::vector<long> values) {
+    KeyPredicate predicate {key, KeyPredicate::Type::LongIn};
+    predicate.longValues.insert(values.begin(), values.end());
+    predicates.push_back(predicate);
+}
+
+void MessageFilter::addKeyIn(std::string key, std::vector<std::string> values) {
+    KeyPredicate predicate {key, KeyPredicate::Type::StringIn};
+    predicate.stringValues.insert(values.begin(), values.end());
+    predicates.push_back(predicate);
+}
+
+void MessageFilter::addKeyBetween(std::string key, double minimum, double maximum) {
+    KeyPredicate predicate {key, KeyPredicate::Type::Between};
+    predicate.minimum = minimum;
+    predicate.maximum = maximum;
+    predicates.push_back(predicate);
+}
+
+bool MessageFilter::empty() const {
+    return predicates.empty();
+}
+
+bool MessageFilter::matches(codes_handle* h) const {
+    for (auto& predicate : predicates) {
+        if (!predicate.matches(h)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::optional<bool> MessageFilter::matches(const MessageIndexEntry& entry) const {
+    for (auto& predicate : predicates) {
+        auto result = predicate.matches(entry);
+        if (!result.has_value()) {
+            return std::nullopt;
+        }
+        if (!result.value()) {
+            return false;
+        }
+    }
+    return true;
+}
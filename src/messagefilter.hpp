@@ -0,0 +1,53 @@
+#ifndef MESSAGE_FILTER_H_INCLUDED
+#define MESSAGE_FILTER_H_INCLUDED
+
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+#include "eccodes.h"
+#include "messageindex.hpp"
+
+// A condition on a single header key
+struct KeyPredicate {
+
+    enum class Type {
+        LongIn,
+        StringIn,
+        Between
+    };
+
+    std::string key;
+    Type type;
+    std::set<long> longValues = {};
+    std::set<std::string> stringValues = {};
+    double minimum = 0;
+    double maximum = 0;
+
+    bool matches(codes_handle* h) const;
+    // Returns nullopt if the key isn't held in the index
+    std::optional<bool> matches(const MessageIndexEntry& entry) const;
+};
+
+// Decides which messages the reader returns using only the header keys of the message.
+// A message is returned when every predicate matches, a message without one of the keys never matches.
+class MessageFilter
+{
+
+    public:
+
+        void addKeyIn(std::string key, std::vector<long> values);
+        void addKeyIn(std::string key, std::vector<std::string> values);
+        void addKeyBetween(std::string key, double minimum, double maximum);
+
+        bool empty() const;
+        bool matches(codes_handle* h) const;
+        // Returns nullopt if any of the keys aren't held in the index
+        std::optional<bool> matches(const MessageIndexEntry& entry) const;
+
+    private:
+
+        std::vector<KeyPredicate> predicates;
+};
+
+#endif /* MESSAGE_FILTER_H_INCLUDED */
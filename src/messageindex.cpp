@@ -0,0 +1,241 @@
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/api.h>
+#include "messageindex.hpp"
+#include "exceptions/arrowgenericexception.hpp"
+
+namespace {
+
+    const std::string indexVersion = "2";
+    const std::string versionKey = "gribtoarrow.index_version";
+    const std::string sourceKey = "gribtoarrow.source";
+
+    std::optional<long> getLong(codes_handle* h, const char* key) {
+        long value;
+        return codes_get_long(h, key, &value) == 0 ? std::optional<long>(value) : std::nullopt;
+    }
+
+    std::optional<std::string> getString(codes_handle* h, const char* key) {
+        char value[256];
+        size_t length = sizeof(value);
+        return codes_get_string(h, key, value, &length) == 0 ? std::optional<std::string>(value) : std::nullopt;
+    }
+
+    template <typename Builder, typename T>
+    arrow::Status appendOrNull(Builder& builder, const std::optional<T>& value) {
+        return value.has_value() ? builder.Append(value.value()) : builder.AppendNull();
+    }
+
+    std::optional<long> longOrNull(const std::shared_ptr<arrow::Int64Array>& array, int64_t i) {
+        return array->IsNull(i) ? std::nullopt : std::optional<long>(array->Value(i));
+    }
+
+    std::optional<std::string> stringOrNull(const std::shared_ptr<arrow::StringArray>& array, int64_t i) {
+        return array->IsNull(i) ? std::nullopt : std::optional<std::string>(array->GetString(i));
+    }
+
+    // Identifies the version of the grib file the index was built from
+    std::optional<std::string> getSourceFingerprint(std::string gribPath) {
+        struct stat fileStat;
+        if (stat(gribPath.c_str(), &fileStat) != 0) {
+            return std::nullopt;
+        }
+        std::ostringstream oss;
+        oss << fileStat.st_size << ":" << fileStat.st_mtime;
+        return oss.str();
+    }
+
+    std::shared_ptr<arrow::Schema> getIndexSchema() {
+        return arrow::schema({
+            arrow::field("messageId", arrow::int64()),
+            arrow::field("offset", arrow::int64()),
+            arrow::field("length", arrow::int64()),
+            arrow::field("paramId", arrow::int64()),
+            arrow::field("shortName", arrow::utf8()),
+            arrow::field("typeOfLevel", arrow::utf8()),
+            arrow::field("level", arrow::int64()),
+            arrow::field("step", arrow::int64()),
+            arrow::field("number", arrow::int64()),
+            arrow::field("date", arrow::int64()),
+            arrow::field("time", arrow::int64()),
+            arrow::field("editionNumber", arrow::int64())
+        });
+    }
+
+    arrow::Result<std::shared_ptr<arrow::Table>> entriesToTable(const std::vector<MessageIndexEntry>& entries) {
+
+        arrow::Int64Builder messageIds, offsets, lengths, parameterIds, levels, steps, numbers, dates, times, editions;
+        arrow::StringBuilder shortNames, typeOfLevels;
+
+        for (auto& entry : entries) {
+            ARROW_RETURN_NOT_OK(messageIds.Append(entry.extent.messageId));
+            ARROW_RETURN_NOT_OK(offsets.Append(entry.extent.offset));
+            ARROW_RETURN_NOT_OK(lengths.Append(entry.extent.length));
+            ARROW_RETURN_NOT_OK(appendOrNull(parameterIds, entry.parameterId));
+            ARROW_RETURN_NOT_OK(appendOrNull(shortNames, entry.shortName));
+            ARROW_RETURN_NOT_OK(appendOrNull(typeOfLevels, entry.typeOfLevel));
+            ARROW_RETURN_NOT_OK(appendOrNull(levels, entry.level));
+            ARROW_RETURN_NOT_OK(appendOrNull(steps, entry.step));
+            ARROW_RETURN_NOT_OK(appendOrNull(numbers, entry.number));
+            ARROW_RETURN_NOT_OK(appendOrNull(dates, entry.date));
+            ARROW_RETURN_NOT_OK(appendOrNull(times, entry.time));
+            ARROW_RETURN_NOT_OK(appendOrNull(editions, entry.editionNumber));
+        }
+
+        std::vector<std::shared_ptr<arrow::Array>> columns(12);
+        ARROW_RETURN_NOT_OK(messageIds.Finish(&columns[0]));
+        ARROW_RETURN_NOT_OK(offsets.Finish(&columns[1]));
+        ARROW_RETURN_NOT_OK(lengths.Finish(&columns[2]));
+        ARROW_RETURN_NOT_OK(parameterIds.Finish(&columns[3]));
+        ARROW_RETURN_NOT_OK(shortNames.Finish(&columns[4]));
+        ARROW_RETURN_NOT_OK(typeOfLevels.Finish(&columns[5]));
+        ARROW_RETURN_NOT_OK(levels.Finish(&columns[6]));
+        ARROW_RETURN_NOT_OK(steps.Finish(&columns[7]));
+        ARROW_RETURN_NOT_OK(numbers.Finish(&columns[8]));
+        ARROW_RETURN_NOT_OK(dates.Finish(&columns[9]));
+        ARROW_RETURN_NOT_OK(times.Finish(&columns[10]));
+        ARROW_RETURN_NOT_OK(editions.Finish(&columns[11]));
+
+        return arrow::Table::Make(getIndexSchema(), columns, (int64_t)entries.size());
+    }
+
+    arrow::Result<std::vector<MessageIndexEntry>> tableToEntries(const std::shared_ptr<arrow::Table>& table) {
+
+        ARROW_ASSIGN_OR_RAISE(auto batch, table->CombineChunksToBatch());
+        if (!batch->schema()->Equals(*getIndexSchema(), false)) {
+            return arrow::Status::Invalid("Index has an unexpected schema");
+        }
+
+        auto longs = [&batch](int i) { return std::static_pointer_cast<arrow::Int64Array>(batch->column(i)); };
+        auto strings = [&batch](int i) { return std::static_pointer_cast<arrow::StringArray>(batch->column(i)); };
+
+        auto messageIds = longs(0), offsets = longs(1), lengths = longs(2), parameterIds = longs(3);
+        auto shortNames = strings(4), typeOfLevels = strings(5);
+        auto levels = longs(6), steps = longs(7), numbers = longs(8), dates = longs(9), times = longs(10), editions = longs(11);
+
+        std::vector<MessageIndexEntry> entries;
+        entries.reserve(batch->num_rows());
+        for (int64_t i = 0; i < batch->num_rows(); i++) {
+            MessageExtent extent {messageIds->Value(i), (off_t)offsets->Value(i), (size_t)lengths->Value(i)};
+            entries.push_back({extent,
+                               longOrNull(parameterIds, i),
+                               stringOrNull(shortNames, i),
+                               stringOrNull(typeOfLevels, i),
+                               longOrNull(levels, i),
+                               longOrNull(steps, i),
+                               longOrNull(numbers, i),
+                               longOrNull(dates, i),
+                               longOrNull(times, i),
+                               longOrNull(editions, i)});
+        }
+        return entries;
+    }
+
+    arrow::Result<std::shared_ptr<arrow::Table>> readIndexFile(std::string indexPath, std::string fingerprint) {
+        ARROW_ASSIGN_OR_RAISE(auto file, arrow::io::MemoryMappedFile::Open(indexPath, arrow::io::FileMode::READ));
+        ARROW_ASSIGN_OR_RAISE(auto reader, arrow::ipc::RecordBatchFileReader::Open(file));
+
+        auto metadata = reader->schema()->metadata();
+        if (metadata == nullptr
+                || metadata->FindKey(versionKey) < 0 || metadata->value(metadata->FindKey(versionKey)) != indexVersion
+                || metadata->FindKey(sourceKey) < 0 || metadata->value(metadata->FindKey(sourceKey)) != fingerprint) {
+            return arrow::Status::Invalid("Index was built from a different version of the grib file");
+        }
+
+        std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+        for (int i = 0; i < reader->num_record_batches(); i++) {
+            ARROW_ASSIGN_OR_RAISE(auto batch, reader->ReadRecordBatch(i));
+            batches.push_back(batch);
+        }
+        return arrow::Table::FromRecordBatches(reader->schema()->RemoveMetadata(), batches);
+    }
+
+    arrow::Status writeIndexFile(std::shared_ptr<arrow::Table> table, std::string indexPath, std::string fingerprint) {
+        auto metadata = arrow::key_value_metadata({versionKey, sourceKey}, {indexVersion, fingerprint});
+        auto schema = table->schema()->WithMetadata(metadata);
+
+        ARROW_ASSIGN_OR_RAISE(auto file, arrow::io::FileOutputStream::Open(indexPath));
+        ARROW_ASSIGN_OR_RAISE(auto writer, arrow::ipc::MakeFileWriter(file, schema));
+        ARROW_RETURN_NOT_OK(writer->WriteTable(*table));
+        ARROW_RETURN_NOT_OK(writer->Close());
+        return file->Close();
+    }
+}
+
+MessageIndex::MessageIndex(std::vector<MessageIndexEntry> entries) : entries(std::move(entries)) {}
+
+MessageIndexEntry MessageIndex::createEntry(const MessageExtent& extent, codes_handle* h) {
+    return {extent,
+            getLong(h, "paramId"),
+            getString(h, "shortName"),
+            getString(h, "typeOfLevel"),
+            getLong(h, "level"),
+            getLong(h, "step"),
+            getLong(h, "number"),
+            getLong(h, "date"),
+            getLong(h, "time"),
+            getLong(h, "editionNumber")};
+}
+
+std::optional<MessageIndex> MessageIndex::load(std::string indexPath, std::string gribPath) {
+
+    auto fingerprint = getSourceFingerprint(gribPath);
+    if (!fingerprint.has_value()) {
+        return std::nullopt;
+    }
+
+    auto table = readIndexFile(indexPath, fingerprint.value());
+    if (!table.ok()) {
+        std::cout << "Not using index " << indexPath << " " << table.status().message() << std::endl;
+        return std::nullopt;
+    }
+
+    auto entries = tableToEntries(table.ValueOrDie());
+    if (!entries.ok()) {
+        std::cout << "Not using index " << indexPath << " " << entries.status().message() << std::endl;
+        return std::nullopt;
+    }
+    return MessageIndex(entries.MoveValueUnsafe());
+}
+
+void MessageIndex::save(std::string indexPath, std::string gribPath) {
+
+    auto fingerprint = getSourceFingerprint(gribPath);
+    if (!fingerprint.has_value()) {
+        return;
+    }
+
+    //The index is only an optimisation so a read only directory shouldn't stop the grib being read
+    auto status = writeIndexFile(toTable(), indexPath, fingerprint.value());
+    if (!status.ok()) {
+        std::cout << "Unable to save index " << indexPath << " " << status.message() << std::endl;
+    }
+}
+
+size_t MessageIndex::size() const {
+    return entries.size();
+}
+
+const MessageIndexEntry& MessageIndex::operator[](size_t messageId) const {
+    return entries[messageId];
+}
+
+std::vector<MessageExtent> MessageIndex::getExtents() const {
+    std::vector<MessageExtent> extents;
+    extents.reserve(entries.size());
+    for (auto& entry : entries) {
+        extents.push_back(entry.extent);
+    }
+    return extents;
+}
+
+std::shared_ptr<arrow::Table> MessageIndex::toTable() const {
+    auto table = entriesToTable(entries);
+    if (!table.ok()) {
+        throw ArrowGenericException("Unable to create index table " + table.status().message());
+    }
+    return table.ValueOrDie();
+}
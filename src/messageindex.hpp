@@ -0,0 +1,53 @@
+#ifndef MESSAGE_INDEX_H_INCLUDED
+#define MESSAGE_INDEX_H_INCLUDED
+
+#include <optional>
+#include <string>
+#include <vector>
+#include <arrow/api.h>
+#include "eccodes.h"
+#include "messagescanner.hpp"
+
+// The position of a message along with the header keys most often used to pick messages
+// A key the message doesn't have is nullopt (null in the saved index)
+struct MessageIndexEntry {
+    MessageExtent extent;
+    std::optional<long> parameterId;
+    std::optional<std::string> shortName;
+    std::optional<std::string> typeOfLevel;
+    std::optional<long> level;
+    std::optional<long> step;
+    std::optional<long> number;
+    std::optional<long> date;
+    std::optional<long> time;
+    std::optional<long> editionNumber;
+};
+
+// Maps a message id to the location of the message in the file so a message
+// can be read without iterating over the messages before it.
+// The index can be saved next to the grib file (as an arrow IPC file) and is
+// only reused whilst the size and modification time of the grib file match.
+class MessageIndex
+{
+
+    public:
+
+        MessageIndex(std::vector<MessageIndexEntry> entries);
+
+        // Reads the header keys of a message, the handle only needs the headers to be decoded
+        static MessageIndexEntry createEntry(const MessageExtent& extent, codes_handle* h);
+
+        static std::optional<MessageIndex> load(std::string indexPath, std::string gribPath);
+        void save(std::string indexPath, std::string gribPath);
+
+        size_t size() const;
+        const MessageIndexEntry& operator[](size_t messageId) const;
+        std::vector<MessageExtent> getExtents() const;
+        std::shared_ptr<arrow::Table> toTable() const;
+
+    private:
+
+        std::vector<MessageIndexEntry> entries;
+};
+
+#endif /* MESSAGE_INDEX_H_INCLUDED */
@@ -0,0 +1,56 @@
+#include "messagemetadata.hpp"
+
+namespace {
+
+    std::optional<long> getLong(codes_handle* h, const char* key) {
+        long value;
+        if (codes_get_long(h, key, &value) != 0) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    std::optional<double> getDouble(codes_handle* h, const char* key) {
+        double value;
+        if (codes_get_double(h, key, &value) != 0) {
+            return std::nullopt;
+        }
+        return value;
+    }
+}
+
+MessageMetadata readMessageMetadata(codes_handle* h) {
+    return {getLong(h, "editionNumber"),
+            getLong(h, "paramId"),
+            getLong(h, "number"),
+            getLong(h, "date"),
+            getLong(h, "time"),
+            getLong(h, "step"),
+            getLong(h, "numberOfPoints"),
+            getDouble(h, "latitudeOfFirstGridPointInDegrees"),
+            getDouble(h, "longitudeOfFirstGridPointInDegrees"),
+            getDouble(h, "latitudeOfLastGridPointInDegrees"),
+            getDouble(h, "longitudeOfLastGridPointInDegrees"),
+            getLong(h, "iScansNegatively"),
+            getLong(h, "jScansPositively"),
+            getLong(h, "bitmapPresent"),
+            getDouble(h, "missingValue"),
+            getLong(h, "gridDefinitionTemplateNumber"),
+            getLong(h, "productDefinitionTemplateNumber")};
+}
+
+int64_t daysFromCivil(int64_t year, unsigned month, unsigned day) {
+    //See http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yearOfEra = (unsigned)(year - era * 400);
+    const unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + (int64_t)dayOfEra - 719468;
+}
+
+std::chrono::system_clock::time_point toTimePoint(long date, long time) {
+    auto days = daysFromCivil(date / 10000, (unsigned)(date / 100 % 100), (unsigned)(date % 100));
+    auto seconds = days * 86400 + (time / 100) * 3600 + (time % 100) * 60;
+    return std::chrono::system_clock::time_point(std::chrono::seconds(seconds));
+}
@@ -0,0 +1,41 @@
+#ifndef MESSAGE_METADATA_H_INCLUDED
+#define MESSAGE_METADATA_H_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include "eccodes.h"
+
+// The header keys used whilst building the results of a message.
+// They are read from the handle once when the message is created rather than each time they are needed.
+// A key the message doesn't have is left empty.
+struct MessageMetadata
+{
+    std::optional<long> editionNumber;
+    std::optional<long> parameterId;
+    std::optional<long> number;
+    std::optional<long> date;
+    std::optional<long> time;
+    std::optional<long> step;
+    std::optional<long> numberOfPoints;
+    std::optional<double> latitudeOfFirstPoint;
+    std::optional<double> longitudeOfFirstPoint;
+    std::optional<double> latitudeOfLastPoint;
+    std::optional<double> longitudeOfLastPoint;
+    std::optional<long> iScansNegatively;
+    std::optional<long> jScansPositively;
+    std::optional<long> bitmapPresent;
+    std::optional<double> missingValue;
+    std::optional<long> gridDefinitionTemplateNumber;
+    std::optional<long> productDefinitionTemplateNumber;
+};
+
+MessageMetadata readMessageMetadata(codes_handle* h);
+
+// Days since 1970-01-01 of a date in the proleptic gregorian calendar
+int64_t daysFromCivil(int64_t year, unsigned month, unsigned day);
+
+// The UTC time of a grib date (YYYYMMDD) and time (HHMM)
+std::chrono::system_clock::time_point toTimePoint(long date, long time);
+
+#endif /*MESSAGE_METADATA_H_INCLUDED*/
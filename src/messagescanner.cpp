@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include "messagescanner.hpp"
+
+namespace {
+
+    const size_t indicatorSectionLength = 16;
+    const size_t searchChunkLength = 64 * 1024;
+    const unsigned char startMarker[] = {'G', 'R', 'I', 'B'};
+    const unsigned char endMarker[] = {'7', '7', '7', '7'};
+
+    // Reads up to length bytes at offset and returns the number of bytes read
+    using ReadAt = std::function<size_t(off_t offset, unsigned char* buffer, size_t length)>;
+
+    size_t lengthFromIndicatorSection(const unsigned char* header, bool& isLargeGrib1) {
+        isLargeGrib1 = false;
+        auto edition = header[7];
+
+        if (edition == 1) {
+            size_t length = ((size_t)header[4] << 16) | ((size_t)header[5] << 8) | header[6];
+            if (length & 0x800000) {
+                //Messages over 8MB set the top bit and give the length in units of 120 bytes
+                isLargeGrib1 = true;
+                return (length & 0x7fffff) * 120;
+            }
+            return length;
+        }
+
+        if (edition == 2) {
+            size_t length = 0;
+            for (size_t i = 8; i < indicatorSectionLength; i++) {
+                length = (length << 8) | header[i];
+            }
+            return length;
+        }
+
+        return 0;
+    }
+
+    bool isEndSection(const unsigned char* bytes) {
+        return std::memcmp(bytes, endMarker, sizeof(endMarker)) == 0;
+    }
+
+    size_t findLargeGrib1Length(ReadAt& readAt, off_t offset, size_t roundedLength) {
+        //The rounded length overshoots the real end of the message by less than 120 bytes
+        //so the end section will be in the last 124 bytes
+        const size_t window = 124;
+        if (roundedLength < window) {
+            return 0;
+        }
+        unsigned char tail[window];
+        auto read = readAt(offset + roundedLength - window, tail, window);
+        for (size_t i = read; i >= sizeof(endMarker); i--) {
+            if (isEndSection(tail + i - sizeof(endMarker))) {
+                return roundedLength - window + i;
+            }
+        }
+        return 0;
+    }
+
+    std::vector<MessageExtent> scanForMessages(ReadAt readAt) {
+        std::vector<MessageExtent> extents;
+        std::vector<unsigned char> chunk(searchChunkLength);
+        off_t position = 0;
+
+        while (true) {
+            unsigned char header[indicatorSectionLength];
+            if (readAt(position, header, indicatorSectionLength) < indicatorSectionLength) {
+                break;
+            }
+
+            if (std::memcmp(header, startMarker, sizeof(startMarker)) != 0) {
+                //Skip anything between messages until we find the start of the next one
+                auto read = readAt(position, chunk.data(), chunk.size());
+                auto end = chunk.data() + read;
+                auto found = std::search(chunk.data(), end, std::begin(startMarker), std::end(startMarker));
+                if (found == end) {
+                    position += read - (sizeof(startMarker) - 1);
+                } else {
+                    position += found - chunk.data();
+                }
+                continue;
+            }
+
+            bool isLargeGrib1;
+            auto length = lengthFromIndicatorSection(header, isLargeGrib1);
+            unsigned char trailer[sizeof(endMarker)];
+            bool hasEndSection = length > indicatorSectionLength
+                                    && readAt(position + length - sizeof(endMarker), trailer, sizeof(trailer)) == sizeof(trailer)
+                                    && isEndSection(trailer);
+
+            if (!hasEndSection) {
+                length = isLargeGrib1 ? findLargeGrib1Length(readAt, position, length) : 0;
+            }
+
+            if (length == 0) {
+                //"GRIB" appeared in the data but wasn't the start of a message
+                position += sizeof(startMarker);
+                continue;
+            }
+
+            extents.push_back({(long)extents.size(), position, length});
+            position += length;
+        }
+
+        return extents;
+    }
+
+}
+
+std::vector<MessageExtent> findMessageExtents(FILE* fin) {
+
+    auto originalPosition = ftello(fin);
+
+    auto extents = scanForMessages([fin](off_t offset, unsigned char* buffer, size_t length) -> size_t {
+        if (fseeko(fin, offset, SEEK_SET) != 0) {
+            return 0;
+        }
+        return fread(buffer, 1, length, fin);
+    });
+
+    fseeko(fin, originalPosition, SEEK_SET);
+    return extents;
+}
+
+std::vector<MessageExtent> findMessageExtents(const unsigned char* data, size_t size) {
+
+    return scanForMessages([data, size](off_t offset, unsigned char* buffer, size_t length) -> size_t {
+        if (offset < 0 || (size_t)offset >= size) {
+            return 0;
+        }
+        auto available = std::min(length, size - (size_t)offset);
+        std::memcpy(buffer, data + offset, available);
+        return available;
+    });
+}
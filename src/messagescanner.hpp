@@ -0,0 +1,26 @@
+#ifndef MESSAGE_SCANNER_H_INCLUDED
+#define MESSAGE_SCANNER_H_INCLUDED
+
+#include <cstdio>
+#include <cstddef>
+#include <vector>
+#include <sys/types.h>
+
+// The position of a single GRIB message within a file.
+// The messageId matches the id given to the message by the iterator
+// i.e. it is the index of the message in the file.
+struct MessageExtent {
+    long messageId;
+    off_t offset;
+    size_t length;
+};
+
+// Finds the start and length of every GRIB message in the file by reading
+// the indicator section (section 0) of each message. No message is decoded.
+// The current position of the file is restored before returning.
+std::vector<MessageExtent> findMessageExtents(FILE* fin);
+
+// As above for a file which has been loaded or mapped into memory
+std::vector<MessageExtent> findMessageExtents(const unsigned char* data, size_t size);
+
+#endif /* MESSAGE_SCANNER_H_INCLUDED */
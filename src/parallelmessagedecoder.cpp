@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <utility>
+#include "gribreader.hpp"
+#include "gribmessage.hpp"
+#include "parallelmessagedecoder.hpp"
+
+ParallelMessageDecoder::ParallelMessageDecoder(GribReader* reader,
+                                               std::vector<MessageExtent> extents,
+                                               unsigned int numberOfThreads,
+                                               unsigned int maxBufferedMessages) :
+                                                    reader(reader),
+                                                    extents(std::move(extents)),
+                                                    maxBufferedMessages(std::max(maxBufferedMessages, numberOfThreads)) {
+
+    for (unsigned int i = 0; i < numberOfThreads; i++) {
+        workers.emplace_back(&ParallelMessageDecoder::decode, this);
+    }
+}
+
+ParallelMessageDecoder::~ParallelMessageDecoder() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    messageReturned.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    //Messages which were decoded but never requested
+    for (auto& buffered : reorderBuffer) {
+        delete buffered.second.message;
+    }
+}
+
+void ParallelMessageDecoder::decode() {
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        //Don't get further ahead of the consumer than the reorder buffer allows
+        messageReturned.wait(lock, [this] {
+            return stopping
+                    || nextToClaim >= extents.size()
+                    || nextToClaim < nextToReturn + maxBufferedMessages;
+        });
+
+        if (stopping || nextToClaim >= extents.size()) {
+            return;
+        }
+
+        auto index = nextToClaim++;
+        lock.unlock();
+
+        DecodedMessage decoded {nullptr, nullptr};
+        codes_handle* h = nullptr;
+        try {
+            auto& extent = extents[index];
+            //A message which is filtered out is left as nullptr and skipped by next()
+            if (reader->acceptsMessage(extent)) {
+                h = reader->createHandle(extent);
+                decoded.message = new GribMessage(reader, h, extent.messageId);
+                decoded.message->prefetch();
+            }
+        } catch (...) {
+            //The message owns the handle once it has been created
+            if (decoded.message != nullptr) {
+                delete decoded.message;
+            } else if (h != nullptr) {
+                codes_handle_delete(h);
+            }
+            decoded.message = nullptr;
+            decoded.error = std::current_exception();
+        }
+
+        lock.lock();
+        reorderBuffer.emplace(index, decoded);
+        messageDecoded.notify_all();
+    }
+}
+
+GribMessage* ParallelMessageDecoder::next() {
+
+    while (true) {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        if (nextToReturn >= extents.size()) {
+            return nullptr;
+        }
+
+        messageDecoded.wait(lock, [this] {
+            return reorderBuffer.find(nextToReturn) != reorderBuffer.end();
+        });
+
+        auto match = reorderBuffer.find(nextToReturn);
+        auto decoded = match->second;
+        reorderBuffer.erase(match);
+        nextToReturn++;
+        lock.unlock();
+        messageReturned.notify_all();
+
+        if (decoded.error) {
+            std::rethrow_exception(decoded.error);
+        }
+        if (decoded.message != nullptr) {
+            return decoded.message;
+        }
+    }
+}
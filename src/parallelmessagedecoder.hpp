@@ -0,0 +1,59 @@
+#ifndef PARALLEL_MESSAGE_DECODER_H_INCLUDED
+#define PARALLEL_MESSAGE_DECODER_H_INCLUDED
+
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "messagescanner.hpp"
+
+class GribReader;
+class GribMessage;
+
+// Decodes messages on a pool of worker threads.
+// Workers claim messages in file order and decode them (including building the
+// arrow table) independently. The results are handed back in message id order
+// through a reorder buffer which holds at most maxBufferedMessages messages so
+// memory stays bounded when the consumer is slower than the workers.
+class ParallelMessageDecoder
+{
+
+    public:
+
+        ParallelMessageDecoder(GribReader* reader,
+                               std::vector<MessageExtent> extents,
+                               unsigned int numberOfThreads,
+                               unsigned int maxBufferedMessages);
+        ~ParallelMessageDecoder();
+
+        // Returns the next message in message id order (skipping messages rejected
+        // by the reader's filters) or nullptr once all messages have been returned.
+        // Ownership passes to the caller.
+        // Any exception raised whilst decoding the message is rethrown here.
+        GribMessage* next();
+
+    private:
+
+        struct DecodedMessage {
+            GribMessage* message;
+            std::exception_ptr error;
+        };
+
+        void decode();
+
+        GribReader* reader;
+        std::vector<MessageExtent> extents;
+        size_t maxBufferedMessages;
+        size_t nextToClaim = 0;
+        size_t nextToReturn = 0;
+        bool stopping = false;
+        std::map<size_t, DecodedMessage> reorderBuffer;
+        std::mutex mutex;
+        std::condition_variable messageDecoded;
+        std::condition_variable messageReturned;
+        std::vector<std::thread> workers;
+};
+
+#endif /* PARALLEL_MESSAGE_DECODER_H_INCLUDED */
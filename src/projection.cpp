@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cmath>
+#include "projection.hpp"
+
+namespace {
+
+    const double TO_RADIANS = M_PI / 180.0;
+    // The radius eccodes uses for the distances returned by grib_nearest_find_multiple
+    const double EARTH_RADIUS_KM = 6371.229;
+
+    // The longitude in the range (-180, 180]
+    double normaliseLongitude(double lon) {
+        auto normalised = std::fmod(lon, 360.0);
+        if (normalised > 180.0) {
+            normalised -= 360.0;
+        } else if (normalised <= -180.0) {
+            normalised += 360.0;
+        }
+        return normalised;
+    }
+
+}
+
+GridProjection::GridProjection(long ni, long nj, bool jPointsAreConsecutive, bool periodic) :
+    ni(ni), nj(nj), jPointsAreConsecutive(jPointsAreConsecutive), periodic(periodic) {}
+
+bool GridProjection::contains(double lat, double lon) const {
+    double i, j;
+    toGrid(lat, lon, i, j);
+    return (periodic || (i >= -0.5 && i <= ni - 0.5)) && j >= -0.5 && j <= nj - 0.5;
+}
+
+int GridProjection::index(long i, long j) const {
+    return jPointsAreConsecutive ? i * nj + j : j * ni + i;
+}
+
+void GridProjection::surroundingPoints(double lat, double lon, int* indexes, double* weights) const {
+    double i, j;
+    toGrid(lat, lon, i, j);
+
+    //Locations outside the grid use the nearest edge, a periodic grid wraps from the last column to the first
+    if (periodic) {
+        i = std::fmod(i, (double)ni);
+        if (i < 0) {
+            i += ni;
+        }
+    } else {
+        i = std::clamp(i, 0.0, (double)(ni - 1));
+    }
+    j = std::clamp(j, 0.0, (double)(nj - 1));
+
+    auto i0 = std::min((long)std::floor(i), ni - 1);
+    auto j0 = std::min((long)std::floor(j), nj - 1);
+    auto i1 = periodic ? (i0 + 1) % ni : std::min(i0 + 1, ni - 1);
+    auto j1 = std::min(j0 + 1, nj - 1);
+    auto fi = i - i0;
+    auto fj = j - j0;
+
+    indexes[0] = index(i0, j0);
+    indexes[1] = index(i1, j0);
+    indexes[2] = index(i0, j1);
+    indexes[3] = index(i1, j1);
+    weights[0] = (1.0 - fi) * (1.0 - fj);
+    weights[1] = fi * (1.0 - fj);
+    weights[2] = (1.0 - fi) * fj;
+    weights[3] = fi * fj;
+}
+
+long GridProjection::getNi() const {
+    return ni;
+}
+
+long GridProjection::getNj() const {
+    return nj;
+}
+
+LatLonProjection::LatLonProjection(const RegularGrid& grid, double southPoleLatitude, double southPoleLongitude) :
+    GridProjection(grid.ni, grid.nj, grid.jPointsAreConsecutive, std::abs(grid.ni * grid.iIncrement - 360.0) < 1e-6),
+    grid(grid), southPoleLatitude(southPoleLatitude), southPoleLongitude(southPoleLongitude) {}
+
+void LatLonProjection::toGrid(double lat, double lon, double& i, double& j) const {
+    auto gridLat = lat;
+    auto gridLon = lon;
+    if (!followsMeridians()) {
+        geographicToRotated(lat, lon, southPoleLatitude, southPoleLongitude, gridLat, gridLon);
+    }
+
+    //The distance east of the first column, locations in the gap of a regional grid go to the nearest side
+    auto offset = std::fmod((gridLon - grid.longitudeOfFirstPoint) * (grid.iScansNegatively ? -1 : 1), 360.0);
+    if (offset < 0) {
+        offset += 360.0;
+    }
+    auto width = (ni - 1) * grid.iIncrement;
+    if (offset > width + (360.0 - width) / 2.0) {
+        offset -= 360.0;
+    }
+    i = offset / grid.iIncrement;
+    j = (gridLat - grid.latitudeOfFirstPoint) * (grid.jScansPositively ? 1 : -1) / grid.jIncrement;
+}
+
+bool LatLonProjection::followsMeridians() const {
+    return southPoleLatitude == -90.0 && southPoleLongitude == 0.0;
+}
+
+LambertConformalProjection::LambertConformalProjection(long nx, long ny, double latitudeOfFirstPoint, double longitudeOfFirstPoint,
+                                                       double latin1, double latin2, double lov, double dx, double dy,
+                                                       bool iScansNegatively, bool jScansPositively, bool jPointsAreConsecutive,
+                                                       double radius) :
+    GridProjection(nx, ny, jPointsAreConsecutive), radius(radius), lov(lov),
+    dx(iScansNegatively ? -dx : dx), dy(jScansPositively ? dy : -dy) {
+
+    //The cone constant and scale of a secant (or tangent when the latitudes are the same) cone
+    auto phi1 = latin1 * TO_RADIANS;
+    auto phi2 = latin2 * TO_RADIANS;
+    if (std::abs(latin1 - latin2) < 1e-9) {
+        n = std::sin(phi1);
+    } else {
+        n = std::log(std::cos(phi1) / std::cos(phi2))
+            / std::log(std::tan(M_PI / 4.0 + phi2 / 2.0) / std::tan(M_PI / 4.0 + phi1 / 2.0));
+    }
+    f = std::cos(phi1) * std::pow(std::tan(M_PI / 4.0 + phi1 / 2.0), n) / n;
+
+    project(latitudeOfFirstPoint, longitudeOfFirstPoint, x0, y0);
+}
+
+void LambertConformalProjection::project(double lat, double lon, double& x, double& y) const {
+    auto rho = radius * f / std::pow(std::tan(M_PI / 4.0 + lat * TO_RADIANS / 2.0), n);
+    auto angle = n * normaliseLongitude(lon - lov) * TO_RADIANS;
+    x = rho * std::sin(angle);
+    y = -rho * std::cos(angle);
+}
+
+void LambertConformalProjection::toGrid(double lat, double lon, double& i, double& j) const {
+    double x, y;
+    project(lat, lon, x, y);
+    i = (x - x0) / dx;
+    j = (y - y0) / dy;
+}
+
+bool LambertConformalProjection::followsMeridians() const {
+    return false;
+}
+
+double greatCircleDistance(double lat1, double lon1, double lat2, double lon2) {
+    auto dLat = (lat2 - lat1) * TO_RADIANS;
+    auto dLon = (lon2 - lon1) * TO_RADIANS;
+    auto a = std::sin(dLat / 2) * std::sin(dLat / 2)
+             + std::cos(lat1 * TO_RADIANS) * std::cos(lat2 * TO_RADIANS) * std::sin(dLon / 2) * std::sin(dLon / 2);
+    return 2.0 * std::asin(std::min(1.0, std::sqrt(a))) * EARTH_RADIUS_KM;
+}
@@ -0,0 +1,83 @@
+#ifndef PROJECTION_H_INCLUDED
+#define PROJECTION_H_INCLUDED
+
+#include "subgrid.hpp"
+
+// Converts geographic coordinates to fractional positions on a grid, i along a row and j between rows with (0, 0)
+// the first point, so the points around a location are found by arithmetic rather than by searching the grid.
+class GridProjection
+{
+public:
+    GridProjection(long ni, long nj, bool jPointsAreConsecutive, bool periodic = false);
+    virtual ~GridProjection() = default;
+
+    virtual void toGrid(double lat, double lon, double& i, double& j) const = 0;
+
+    // True when the rows and columns follow the parallels and meridians so the first and last points bound the grid
+    virtual bool followsMeridians() const = 0;
+
+    // True if the location is within half a grid length of the points of the grid
+    bool contains(double lat, double lon) const;
+
+    // The index of the point in column i and row j in the order of the values of the message
+    int index(long i, long j) const;
+
+    // The 4 points of the grid cell around the location (the nearest edge for locations outside the grid)
+    // and their bilinear weights
+    void surroundingPoints(double lat, double lon, int* indexes, double* weights) const;
+
+    long getNi() const;
+    long getNj() const;
+
+protected:
+    long ni;
+    long nj;
+    bool jPointsAreConsecutive;
+    // The last column is followed by the first (a global latitude / longitude grid)
+    bool periodic;
+};
+
+// A regular latitude / longitude grid, or a rotated grid when the south pole isn't at -90
+class LatLonProjection : public GridProjection
+{
+public:
+    LatLonProjection(const RegularGrid& grid, double southPoleLatitude = -90.0, double southPoleLongitude = 0.0);
+
+    void toGrid(double lat, double lon, double& i, double& j) const override;
+    bool followsMeridians() const override;
+
+private:
+    RegularGrid grid;
+    double southPoleLatitude;
+    double southPoleLongitude;
+};
+
+// A lambert conformal grid on a spherical earth (gridType lambert)
+class LambertConformalProjection : public GridProjection
+{
+public:
+    LambertConformalProjection(long nx, long ny, double latitudeOfFirstPoint, double longitudeOfFirstPoint,
+                               double latin1, double latin2, double lov, double dx, double dy,
+                               bool iScansNegatively, bool jScansPositively, bool jPointsAreConsecutive, double radius);
+
+    void toGrid(double lat, double lon, double& i, double& j) const override;
+    bool followsMeridians() const override;
+
+private:
+    double n;
+    double f;
+    double radius;
+    double lov;
+    double dx;
+    double dy;
+    // The projected coordinates of the first point
+    double x0;
+    double y0;
+
+    void project(double lat, double lon, double& x, double& y) const;
+};
+
+// The great circle distance in km using the same earth radius as eccodes
+double greatCircleDistance(double lat1, double lon1, double lat2, double lon2);
+
+#endif /*PROJECTION_H_INCLUDED*/
@@ -0,0 +1,40 @@
+#include <iomanip>
+#include <sstream>
+#include "stablehash.hpp"
+
+StableHash& StableHash::add(const void* data, size_t length) {
+    auto bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return *this;
+}
+
+StableHash& StableHash::add(const std::string& value) {
+    //The length separates consecutive strings
+    add((int64_t)value.size());
+    return add(value.data(), value.size());
+}
+
+StableHash& StableHash::add(double value) {
+    //0.0 and -0.0 compare equal so must hash the same
+    if (value == 0.0) {
+        value = 0.0;
+    }
+    return add(&value, sizeof(value));
+}
+
+StableHash& StableHash::add(int64_t value) {
+    return add(&value, sizeof(value));
+}
+
+uint64_t StableHash::value() const {
+    return hash;
+}
+
+std::string StableHash::toString() const {
+    std::ostringstream oss;
+    oss << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return oss.str();
+}
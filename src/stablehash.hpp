@@ -0,0 +1,25 @@
+#ifndef STABLE_HASH_H_INCLUDED
+#define STABLE_HASH_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// A 64 bit FNV-1a hash which is the same in every process and on every run (unlike std::hash)
+// so it can identify grids in files as well as in memory
+class StableHash
+{
+    public:
+        StableHash& add(const void* data, size_t length);
+        StableHash& add(const std::string& value);
+        StableHash& add(double value);
+        StableHash& add(int64_t value);
+        uint64_t value() const;
+        // The hash as 16 hex digits
+        std::string toString() const;
+
+    private:
+        uint64_t hash = 14695981039346656037ull;
+};
+
+#endif /*STABLE_HASH_H_INCLUDED*/
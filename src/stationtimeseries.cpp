@@ -0,0 +1,164 @@
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#include <arrow/compute/api.h>
+#include <arrow/util/bit_util.h>
+#include <arrow/util/key_value_metadata.h>
+#include "stationtimeseries.hpp"
+#include "exceptions/arrowgenericexception.hpp"
+#include "exceptions/gribexception.hpp"
+#include "exceptions/invalidschemaexception.hpp"
+
+namespace cp = arrow::compute;
+
+namespace {
+
+    std::shared_ptr<arrow::Buffer> allocateZeroed(int64_t size) {
+        auto buffer = arrow::AllocateBuffer(size);
+        if (!buffer.ok()) {
+            throw ArrowGenericException("Unable to allocate a time series column " + buffer.status().message());
+        }
+        std::shared_ptr<arrow::Buffer> allocated = std::move(buffer).ValueOrDie();
+        std::memset(allocated->mutable_data(), 0, size);
+        return allocated;
+    }
+
+    std::shared_ptr<arrow::Array> castTo(std::shared_ptr<arrow::Array> array, std::shared_ptr<arrow::DataType> type) {
+        if (array->type()->Equals(type)) {
+            return array;
+        }
+        auto cast = cp::Cast(*array, type);
+        if (!cast.ok()) {
+            throw ArrowGenericException("Unable to cast " + array->type()->ToString() + " to " + type->ToString() 
+                                        + " " + cast.status().message());
+        }
+        return cast.ValueOrDie();
+    }
+
+    std::string formatValidTime(int64_t validTime) {
+        auto seconds = (std::time_t)(validTime / 1000000);
+        std::tm utc;
+        gmtime_r(&seconds, &utc);
+        char formatted[32];
+        std::strftime(formatted, sizeof(formatted), "%Y-%m-%dT%H:%M:%S", &utc);
+        return formatted;
+    }
+
+    //Writes each value to its row, a cell which already holds a value means two messages had the same key
+    template <typename T>
+    void scatter(const arrow::Array& values, const std::vector<int64_t>& positions, T* target, uint8_t* validity,
+                 long parameterId, int64_t validTime) {
+
+        auto source = values.data()->GetValues<T>(1);
+        for (int64_t i = 0; i < values.length(); i++) {
+            auto row = positions[i];
+            if (values.IsNull(i)) {
+                continue;
+            }
+            if (arrow::bit_util::GetBit(validity, row)) {
+                std::ostringstream oss;
+                oss << "More than one message has parameterId " << parameterId << " valid at " << formatValidTime(validTime)
+                    << ", use withFilter to select a single level and ensemble member";
+                throw GribException(oss.str());
+            }
+            target[row] = source[i];
+            arrow::bit_util::SetBit(validity, row);
+        }
+    }
+
+}
+
+StationTimeSeries::StationTimeSeries(std::shared_ptr<arrow::Table> locations, std::shared_ptr<arrow::DataType> valueType) :
+    locations(locations), valueType(valueType), numberOfRows(locations->num_rows()) {
+
+    auto surrogateKeys = locations->GetColumnByName("surrogate_key");
+    if (!surrogateKeys) {
+        throw InvalidSchemaException("The locations of a time series need a surrogate_key column");
+    }
+
+    auto keys = cp::Cast(surrogateKeys, arrow::int64());
+    if (!keys.ok()) {
+        throw ArrowGenericException("Unable to read the surrogate keys " + keys.status().message());
+    }
+    int64_t row = 0;
+    rows.reserve(numberOfRows);
+    for (auto& chunk : keys.ValueOrDie().chunked_array()->chunks()) {
+        auto keyValues = std::static_pointer_cast<arrow::Int64Array>(chunk);
+        for (int64_t i = 0; i < keyValues->length(); i++, row++) {
+            if (keyValues->IsValid(i)) {
+                rows[keyValues->Value(i)] = row;
+            }
+        }
+    }
+}
+
+const std::vector<int64_t>& StationTimeSeries::getPositions(std::shared_ptr<arrow::Array> surrogateKeys) {
+
+    auto found = positions.find(surrogateKeys.get());
+    if (found != positions.end()) {
+        return found->second.second;
+    }
+
+    auto keys = std::static_pointer_cast<arrow::Int64Array>(castTo(surrogateKeys, arrow::int64()));
+    std::vector<int64_t> keyRows(keys->length());
+    for (int64_t i = 0; i < keys->length(); i++) {
+        auto row = keys->IsValid(i) ? rows.find(keys->Value(i)) : rows.end();
+        if (row == rows.end()) {
+            throw InvalidSchemaException("The surrogate key of row " + std::to_string(i) + " isn't one of the locations of the time series");
+        }
+        keyRows[i] = row->second;
+    }
+    //The array is kept so its address isn't reused by another array
+    return positions.emplace(surrogateKeys.get(), std::make_pair(surrogateKeys, std::move(keyRows))).first->second.second;
+}
+
+StationTimeSeries::Column& StationTimeSeries::getColumn(long parameterId, int64_t validTime) {
+    auto key = std::make_pair(parameterId, validTime);
+    auto found = columns.find(key);
+    if (found != columns.end()) {
+        return found->second;
+    }
+    //Every location starts as null until a message writes its value
+    auto byteWidth = valueType->byte_width();
+    Column column {allocateZeroed(numberOfRows * byteWidth), allocateZeroed(arrow::bit_util::BytesForBits(numberOfRows))};
+    return columns.emplace(key, column).first->second;
+}
+
+void StationTimeSeries::add(long parameterId, int64_t validTime, std::shared_ptr<arrow::Array> surrogateKeys,
+                            std::shared_ptr<arrow::Array> values) {
+
+    if (surrogateKeys->length() != values->length()) {
+        throw InvalidSchemaException("The surrogate keys and values of a time series must be the same length");
+    }
+    auto& keyRows = getPositions(surrogateKeys);
+    auto& column = getColumn(parameterId, validTime);
+    auto typedValues = castTo(values, valueType);
+
+    auto validity = column.validity->mutable_data();
+    if (valueType->id() == arrow::Type::FLOAT) {
+        scatter(*typedValues, keyRows, (float*)column.values->mutable_data(), validity, parameterId, validTime);
+    } else {
+        scatter(*typedValues, keyRows, (double*)column.values->mutable_data(), validity, parameterId, validTime);
+    }
+}
+
+std::shared_ptr<arrow::Table> StationTimeSeries::toTable() {
+
+    arrow::FieldVector fields = locations->schema()->fields();
+    arrow::ChunkedArrayVector arrays = locations->columns();
+
+    for (auto& [key, column] : columns) {
+        auto validTime = formatValidTime(key.second);
+        auto metadata = arrow::key_value_metadata({"parameterId", "datetime"}, {std::to_string(key.first), validTime});
+        fields.push_back(arrow::field(std::to_string(key.first) + "_" + validTime, valueType, true, metadata));
+
+        auto data = arrow::ArrayData::Make(valueType, numberOfRows, {column.validity, column.values}, arrow::kUnknownNullCount);
+        arrays.push_back(std::make_shared<arrow::ChunkedArray>(arrow::MakeArray(data)));
+    }
+
+    return arrow::Table::Make(arrow::schema(fields), arrays, numberOfRows);
+}
+
+size_t StationTimeSeries::getNumberOfColumns() {
+    return columns.size();
+}
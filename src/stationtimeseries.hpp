@@ -0,0 +1,56 @@
+#ifndef STATION_TIME_SERIES_H_INCLUDED
+#define STATION_TIME_SERIES_H_INCLUDED
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <arrow/api.h>
+
+// Collects the values of many messages at the locations of a reader into a wide table with a row per
+// location and a column per parameter and valid time. Each column is allocated once for every location and
+// the values of a message are written straight into it, so the location columns are only held once rather
+// than once per message and no pivot is needed afterwards. Locations a message doesn't cover are null.
+class StationTimeSeries
+{
+    public:
+
+        // locations must have a surrogate_key column, the rows of the result are in the same order
+        StationTimeSeries(std::shared_ptr<arrow::Table> locations, std::shared_ptr<arrow::DataType> valueType);
+
+        // Writes the values of a message, surrogateKeys identifies the location of each value
+        // validTime is in microseconds since the epoch (as the datetime column)
+        void add(long parameterId, int64_t validTime, std::shared_ptr<arrow::Array> surrogateKeys,
+                 std::shared_ptr<arrow::Array> values);
+
+        // The columns of the locations followed by a column per parameter and valid time ordered by parameterId
+        // then valid time. The columns are named parameterId_validtime and the field metadata holds both parts.
+        std::shared_ptr<arrow::Table> toTable();
+
+        size_t getNumberOfColumns();
+
+    private:
+
+        struct Column
+        {
+            std::shared_ptr<arrow::Buffer> values;
+            std::shared_ptr<arrow::Buffer> validity;
+        };
+
+        std::shared_ptr<arrow::Table> locations;
+        std::shared_ptr<arrow::DataType> valueType;
+        int64_t numberOfRows;
+        std::map<std::pair<long, int64_t>, Column> columns;
+        // The row of each surrogate key
+        std::unordered_map<int64_t, int64_t> rows;
+        // The rows of the surrogate keys of each location table seen so far, messages on the same grid
+        // share the same surrogate key array so the rows are only looked up once per grid
+        std::unordered_map<const arrow::Array*, std::pair<std::shared_ptr<arrow::Array>, std::vector<int64_t>>> positions;
+
+        const std::vector<int64_t>& getPositions(std::shared_ptr<arrow::Array> surrogateKeys);
+        Column& getColumn(long parameterId, int64_t validTime);
+};
+
+#endif /*STATION_TIME_SERIES_H_INCLUDED*/
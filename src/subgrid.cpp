@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <cmath>
+#include "subgrid.hpp"
+
+namespace {
+
+    // Grid coordinates are computed from increments so allow for rounding
+    const double TOLERANCE = 1e-6;
+
+    // The angle from west to lon going east in the range [0, 360)
+    double eastOf(double west, double lon) {
+        auto difference = std::fmod(lon - west, 360.0);
+        return difference < 0 ? difference + 360.0 : difference;
+    }
+
+}
+
+std::vector<int> regularGridWindow(const RegularGrid& grid, double north, double west, double south, double east) {
+    std::vector<long> rows;
+    for (long j = 0; j < grid.nj; j++) {
+        auto lat = grid.latitudeOfFirstPoint + j * grid.jIncrement * (grid.jScansPositively ? 1 : -1);
+        if (lat >= south - TOLERANCE && lat <= north + TOLERANCE) {
+            rows.push_back(j);
+        }
+    }
+
+    auto width = east - west;
+    if (width < 0) {
+        width += 360.0;
+    }
+    std::vector<long> columns;
+    for (long i = 0; i < grid.ni; i++) {
+        auto lon = grid.longitudeOfFirstPoint + i * grid.iIncrement * (grid.iScansNegatively ? -1 : 1);
+        auto offset = eastOf(west, lon);
+        //A point just west of the area is 360 degrees east of it
+        if (width >= 360.0 || offset <= width + TOLERANCE || offset >= 360.0 - TOLERANCE) {
+            columns.push_back(i);
+        }
+    }
+
+    std::vector<int> indexes;
+    indexes.reserve(rows.size() * columns.size());
+    for (auto j : rows) {
+        for (auto i : columns) {
+            indexes.push_back(grid.jPointsAreConsecutive ? i * grid.nj + j : j * grid.ni + i);
+        }
+    }
+    //Return the points in the order of the values so the subgrid is read sequentially
+    std::sort(indexes.begin(), indexes.end());
+    return indexes;
+}
+
+void geographicToRotated(double lat, double lon, double southPoleLatitude, double southPoleLongitude,
+                         double& rotatedLat, double& rotatedLon) {
+    auto toRadians = M_PI / 180.0;
+    auto phi = lat * toRadians;
+    auto lambda = (lon - southPoleLongitude) * toRadians;
+
+    auto x = std::cos(phi) * std::cos(lambda);
+    auto y = std::cos(phi) * std::sin(lambda);
+    auto z = std::sin(phi);
+
+    //Rotating about the y axis by 90 degrees plus the latitude of the south pole moves the pole to -90
+    auto theta = (90.0 + southPoleLatitude) * toRadians;
+    auto rotatedX = std::cos(theta) * x + std::sin(theta) * z;
+    auto rotatedZ = -std::sin(theta) * x + std::cos(theta) * z;
+
+    rotatedLat = std::asin(std::clamp(rotatedZ, -1.0, 1.0)) / toRadians;
+    rotatedLon = std::atan2(y, rotatedX) / toRadians;
+}
@@ -0,0 +1,29 @@
+#ifndef SUB_GRID_H_INCLUDED
+#define SUB_GRID_H_INCLUDED
+
+#include <vector>
+
+// The geometry of a regular latitude / longitude grid (or of a rotated grid in rotated coordinates)
+struct RegularGrid
+{
+    long ni;
+    long nj;
+    double latitudeOfFirstPoint;
+    double longitudeOfFirstPoint;
+    double iIncrement;
+    double jIncrement;
+    bool iScansNegatively;
+    bool jScansPositively;
+    bool jPointsAreConsecutive;
+};
+
+// The indexes (in the order of the values of the message) of the points in the rows between south and north
+// and the columns between west and east. west can be greater than east for an area crossing the antimeridian.
+std::vector<int> regularGridWindow(const RegularGrid& grid, double north, double west, double south, double east);
+
+// Converts geographic coordinates to the coordinates of a grid rotated so its south pole is at
+// southPoleLatitude, southPoleLongitude (the grib definition of rotated_ll with no angle of rotation)
+void geographicToRotated(double lat, double lon, double southPoleLatitude, double southPoleLongitude,
+                         double& rotatedLat, double& rotatedLon);
+
+#endif /*SUB_GRID_H_INCLUDED*/
@@ -0,0 +1,27 @@
+#include <set>
+#include "valueextraction.hpp"
+
+namespace {
+
+    // Packings where eccodes unpacks a single value directly, every other packing decodes the whole field
+    // for each call to codes_get_double_elements
+    const std::set<std::string> ELEMENT_PACKINGS = {"grid_simple", "grid_ieee"};
+
+    // Beyond 1 value in this many a sequential decode of the whole field is faster than unpacking each value
+    const long FULL_DECODE_RATIO = 16;
+
+}
+
+ValueExtraction chooseValueExtraction(const std::string& packingType, long requestedValues, long numberOfPoints) {
+    if (ELEMENT_PACKINGS.count(packingType) == 0) {
+        return ValueExtraction::FullDecode;
+    }
+    return requestedValues * FULL_DECODE_RATIO >= numberOfPoints ? ValueExtraction::FullDecode : ValueExtraction::Elements;
+}
+
+void gatherValues(const double* decoded, const int* indexes, size_t count, double* values) {
+    //A branch free loop the compiler can turn into vector gathers
+    for (size_t i = 0; i < count; i++) {
+        values[i] = decoded[indexes[i]];
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef VALUE_EXTRACTION_H_INCLUDED
+#define VALUE_EXTRACTION_H_INCLUDED
+
+#include <cstddef>
+#include <string>
+
+// How the values at the locations are read from a message
+// Elements uses codes_get_double_elements, FullDecode decodes every value once and gathers the locations
+// Auto chooses between them using the packing type of the message and the number of values needed
+enum class ValueExtraction { Auto, Elements, FullDecode };
+
+// Which path was used to read the values at the locations of a message
+struct ExtractionStats
+{
+    ValueExtraction method;
+    std::string packingType;
+    // The number of values read, the number of locations times the points used to interpolate each one
+    long requestedValues;
+    long numberOfPoints;
+    double milliseconds;
+};
+
+// Elements is only cheaper for packings which can unpack a single value without decoding the rest of the field
+// and only while a small fraction of the field is requested
+ValueExtraction chooseValueExtraction(const std::string& packingType, long requestedValues, long numberOfPoints);
+
+// values[i] = decoded[indexes[i]]
+void gatherValues(const double* decoded, const int* indexes, size_t count, double* values);
+
+#endif /*VALUE_EXTRACTION_H_INCLUDED*/
@@ -0,0 +1,58 @@
+import polars as pl
+
+class TestCacheLimit:
+
+    def __getLocations(self):
+        # kristiansand (sorlandet) and Bergen (West Norway)
+        return pl.DataFrame({"lat": [58.1599, 60.3913], "lon": [8.0182, 5.3221]}).to_arrow()
+
+    def test_one_grid_is_searched_once(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withLocations(self.__getLocations())
+        for message in reader:
+            message.getDataWithLocations()
+
+        stats = reader.getCacheStats()["locations"]
+        assert stats.misses == 1
+        assert stats.hits == 84
+        assert stats.evictions == 0
+        assert stats.entries == 1
+        assert stats.bytes > 0
+
+    def test_grids_are_evicted_over_limit(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = (
+            GribReader(str(resource) + "/norway.grb")
+            .withLocations(self.__getLocations())
+            .withCacheLimit(1)
+        )
+        df = pl.concat(pl.from_arrow(message.getDataWithLocations()) for message in reader)
+
+        stats = reader.getCacheStats()["locations"]
+        # The most recently used grid is always kept
+        assert stats.entries == 1
+        assert stats.evictions >= 1
+        assert stats.capacityBytes == 1
+        assert len(df) == 510
+
+    def test_passed_through_columns_are_gathered_once(self, resource):
+        from gribtoarrow import GribReader
+
+        # Each grid of norway.grb only has one of the locations so the location_id column is gathered for the grid
+        locations = pl.DataFrame({"location_id": [1, 2], "lat": [58.1599, 60.3913], "lon": [8.0182, 5.3221]}).to_arrow()
+        reader = GribReader(str(resource) + "/norway.grb").withLocations(locations)
+        message = reader[0]
+
+        message.getDataWithLocations(["surrogate_key", "value"])
+        withoutColumn = reader.getCacheStats()["locations"].bytes
+
+        first = message.getDataWithLocations()
+        withColumn = reader.getCacheStats()["locations"].bytes
+        assert withColumn > withoutColumn
+
+        second = message.getDataWithLocations()
+        assert reader.getCacheStats()["locations"].bytes == withColumn
+        assert first.equals(second)
+        assert len(first.column("location_id")) == 1
@@ -0,0 +1,44 @@
+import pyarrow as pa
+
+class TestColumnEncoding:
+
+    def __getLocations(self):
+        # Locations are Canary Wharf and Manchester
+        return pa.Table.from_pydict({"lat": [51.5054, 53.4808], "lon": [-0.027176, 2.2426]})
+
+    def test_run_end_encoding(self, resource):
+        from gribtoarrow import GribReader, ColumnEncoding
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+        expected = reader[0].getData(["Values", "parameterId", "datetime"])
+
+        reader = reader.withConstantColumnEncoding(ColumnEncoding.RunEnd)
+        table = reader[0].getData(["Values", "parameterId", "datetime"])
+
+        parameterIds = table.column("parameterId")
+        assert pa.types.is_run_end_encoded(parameterIds.type)
+        assert parameterIds.chunk(0).values.to_pylist() == [156]
+        assert table.column("datetime").cast(pa.timestamp("us")).equals(expected.column("datetime"))
+
+    def test_dictionary_encoding_with_locations(self, resource):
+        from gribtoarrow import GribReader, ColumnEncoding
+
+        reader = (GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+                    .withLocations(self.__getLocations())
+                    .withConstantColumnEncoding(ColumnEncoding.Dictionary))
+        table = reader[0].getDataWithLocations()
+
+        parameterIds = table.column("parameterId")
+        assert pa.types.is_dictionary(parameterIds.type)
+        assert parameterIds.to_pylist() == [156, 156]
+
+    def test_stream_schema(self, resource):
+        from gribtoarrow import GribReader, ColumnEncoding
+
+        reader = (GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+                    .withConstantColumnEncoding(ColumnEncoding.RunEnd)
+                    .withColumns(["Values", "parameterId"]))
+        stream = reader.toRecordBatchReader()
+
+        assert pa.types.is_run_end_encoded(stream.schema.field("parameterId").type)
+        assert sum(batch.num_rows for batch in stream) == 85 * 259920
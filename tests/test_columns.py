@@ -0,0 +1,65 @@
+import polars as pl
+import pytest
+
+class TestColumns:
+
+    def __getLocations(self):
+        # Locations are Canary Wharf and Manchester
+        return pl.DataFrame(
+            {"lat": [51.5054, 53.4808], "lon": [-0.027176, 2.2426]}
+        ).to_arrow()
+
+    def test_get_data_values_only(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+        expected = pl.from_arrow(reader[0].getData())
+
+        df = pl.from_arrow(reader[0].getData(["Values"]))
+
+        assert df.columns == ["Values"]
+        assert df["Values"].equals(expected["Values"])
+
+    def test_get_data_message_columns(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+        df = pl.from_arrow(reader[0].getData(["datetime", "Values", "parameterId"]))
+
+        assert df.columns == ["datetime", "Values", "parameterId"]
+        assert df["parameterId"].unique().to_list() == [156]
+
+    def test_get_data_with_locations_projection(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(
+            str(resource) + "/gep01.t00z.pgrb2a.0p50.f003"
+        ).withLocations(self.__getLocations())
+
+        expected = pl.from_arrow(reader[0].getDataWithLocations())
+        df = pl.from_arrow(reader[0].getDataWithLocations(["surrogate_key", "datetime", "value"]))
+
+        assert df.columns == ["surrogate_key", "datetime", "value"]
+        assert df.equals(expected.select(["surrogate_key", "datetime", "value"]))
+
+    def test_reader_columns(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(
+            str(resource) + "/gep01.t00z.pgrb2a.0p50.f003"
+        ).withLocations(self.__getLocations()).withColumns(["surrogate_key", "value"]).withThreads(2)
+
+        for message in reader:
+            assert message.getDataWithLocations().column_names == ["surrogate_key", "value"]
+
+        stream = reader.toRecordBatchReader()
+        assert stream.schema.names == ["surrogate_key", "value"]
+        assert stream.read_all().num_rows == 85 * 2
+
+    def test_unknown_column(self, resource):
+        import gribtoarrow
+
+        reader = gribtoarrow.GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+
+        with pytest.raises(gribtoarrow.InvalidSchemaException):
+            reader[0].getData(["Temperature"])
@@ -1,6 +1,7 @@
 import polars as pl
 import pytest
 import os
+import math
 import pyarrow as pa
 
 class TestConversions:
@@ -318,4 +319,86 @@ class TestConversions:
 
         converted_df = self.get_2t_df(reader)
 
-        assert round(converted_df["value"].to_list()[0], 2) == round(28.012, 2)
\ No newline at end of file
+        assert round(converted_df["value"].to_list()[0], 2) == round(28.012, 2)
+
+    def test_combined_operations(self, resource):
+        # Every operation of the row is applied (x + a) * m / d - s
+        # tcc is 100 at Canary Wharf so (100 + 20) * 50 / 100 - 10 = 50
+
+        from gribtoarrow import GribReader
+
+        locations = pl.DataFrame({"lat": [51.5054], "lon": [-0.027176]}).to_arrow()
+
+        conversions = self.getCastConversions({
+            "parameterId": [228164],
+            "addition_value": [20],
+            "subtraction_value": [10],
+            "multiplication_value": [50],
+            "division_value": [100]}
+        )
+
+        reader = (
+            GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+            .withLocations(locations)
+            .withConversions(conversions)
+        )
+
+        converted_df = self.get_tcc_df(reader)
+
+        assert converted_df["value"].to_list()[0] == 50
+
+    def test_nulls_are_kept(self, resource):
+        # The land points of the ocean model are missing so their values stay null once converted
+        import pyarrow.compute as pc
+        from gribtoarrow import GribReader
+
+        path = str(resource) + "/norkyst800m_weatherapi_west_norway.grb"
+        message = GribReader(path)[0]
+        grid = pl.from_arrow(message.getData(["Latitudes", "Longitudes", "Values"]))
+        land = grid.filter(pl.col("Values").is_null()).row(0, named=True)
+        sea = grid.filter(pl.col("Values").is_not_null()).row(0, named=True)
+        locations = pl.DataFrame(
+            {"lat": [land["Latitudes"], sea["Latitudes"]], "lon": [land["Longitudes"], sea["Longitudes"]]}
+        ).to_arrow()
+
+        conversions = self.getCastConversions(
+            {"parameterId": [message.getParameterId()], "addition_value": [1.0], "ceiling_value": [1000.0]}
+        )
+
+        expected = GribReader(path).withLocations(locations)[0].getDataWithLocations().column("value")
+        values = GribReader(path).withLocations(locations).withConversions(conversions)[0].getDataWithLocations().column("value")
+
+        assert values.null_count == expected.null_count == 1
+        assert pc.all(pc.equal(values, pc.add(expected, 1.0))).as_py()
+
+    def test_ceiling(self, resource):
+        # 2t is 6.978 Celcius at Canary Wharf so a ceiling of 5 caps it
+
+        from gribtoarrow import GribReader
+
+        locations = pl.DataFrame({"lat": [51.5054], "lon": [-0.027176]}).to_arrow()
+
+        conversions = self.getCastConversions({"addition_value": [-273.15], "ceiling_value": [5]})
+
+        reader = (
+            GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+            .withLocations(locations)
+            .withConversions(conversions)
+        )
+
+        converted_df = self.get_2t_df(reader)
+
+        assert converted_df["value"].to_list()[0] == 5
+
+        # A NaN value isn't replaced by the ceiling
+        conversions = self.getCastConversions({"addition_value": [float("nan")], "ceiling_value": [5]})
+
+        reader = (
+            GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+            .withLocations(locations)
+            .withConversions(conversions)
+        )
+
+        converted_df = self.get_2t_df(reader)
+
+        assert math.isnan(converted_df["value"].to_list()[0])
@@ -0,0 +1,28 @@
+import polars as pl
+from polars.testing import assert_series_equal
+
+class TestCoordinateCache:
+
+    def test_messages_on_same_grid_share_coordinates(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+        first, second = (pl.from_arrow(message.getData()) for message in reader[0:2])
+
+        assert first.shape[0] == 259920
+        assert_series_equal(first["Latitudes"], second["Latitudes"])
+        assert_series_equal(first["Longitudes"], second["Longitudes"])
+        assert not first["Values"].equals(second["Values"])
+
+    def test_cached_coordinates_match_first_decode(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+        #Only one message has been decoded so the coordinates come from codes_grib_get_data
+        expected = pl.from_arrow(reader[5].getData())
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+        reader[0].getData()
+        df = pl.from_arrow(reader[5].getData())
+
+        assert expected.equals(df)
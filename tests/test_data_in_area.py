@@ -0,0 +1,50 @@
+import polars as pl
+import pytest
+
+class TestDataInArea:
+
+    def __getMessage(self, resource):
+        from gribtoarrow import GribReader
+
+        return GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")[0]
+
+    def __filterData(self, message, north, west, south, east):
+        df = pl.from_arrow(message.getData(["Latitudes", "Longitudes", "Values"]))
+        lons = (pl.col("Longitudes") - west) % 360
+        return df.filter(
+            pl.col("Latitudes").is_between(south, north) & (lons <= (east - west) % 360)
+        )
+
+    def __sorted(self, df):
+        return df.sort(["Latitudes", "Longitudes"])
+
+    def test_area_matches_filtered_data(self, resource):
+        message = self.__getMessage(resource)
+
+        area = pl.from_arrow(message.getDataInArea(60, -10, 50, 2))
+        expected = self.__filterData(message, 60, -10, 50, 2)
+
+        assert area.shape[0] > 0
+        assert self.__sorted(area).equals(self.__sorted(expected))
+
+    def test_area_crossing_antimeridian(self, resource):
+        message = self.__getMessage(resource)
+
+        area = pl.from_arrow(message.getDataInArea(10, 170, -10, -170))
+        expected = self.__filterData(message, 10, 170, -10, -170)
+
+        assert area.shape[0] == 41 * 41
+        assert self.__sorted(area).equals(self.__sorted(expected))
+
+    def test_area_columns(self, resource):
+        message = self.__getMessage(resource)
+
+        area = message.getDataInArea(1, 0, 0, 1)
+        assert area.column_names == ["Latitudes", "Longitudes", "Values"]
+        assert area.num_rows == 9
+
+    def test_empty_area(self, resource):
+        message = self.__getMessage(resource)
+
+        area = message.getDataInArea(0.2, 0.1, 0.1, 0.2)
+        assert area.num_rows == 0
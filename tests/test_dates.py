@@ -46,3 +46,17 @@ class TestLocations:
         assert all(x == 0 for x in date_hours)
         assert all(x == 18 for x in forecast_hours)
 
+
+    def test_forecast_date_is_utc(self, resource):
+        import datetime
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+        message = reader[0]
+        date = message.getDateNumeric()
+
+        df = pl.from_arrow(message.getData(["forecast_date", "datetime"]))
+        expected = datetime.datetime(date // 10000, date // 100 % 100, date % 100)
+
+        assert df["forecast_date"].unique().to_list() == [expected]
+        assert df["datetime"].unique().to_list() == [expected + datetime.timedelta(hours=3)]
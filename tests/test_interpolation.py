@@ -0,0 +1,54 @@
+import polars as pl
+import pytest
+
+class TestInterpolation:
+
+    def __getValues(self, resource, lats, lons, method, neighbours=4):
+        from gribtoarrow import GribReader
+
+        reader = (
+            GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+            .withLocations(pl.DataFrame({"lat": lats, "lon": lons}).to_arrow())
+            .withInterpolation(method, neighbours)
+        )
+        return pl.from_arrow(reader[0].getDataWithLocations()).sort("surrogate_key")["value"].to_list()
+
+    def test_grid_points_keep_their_value(self, resource):
+        from gribtoarrow import InterpolationMethod
+
+        lats, lons = [51.5, 10.0, -33.5], [0.0, 20.5, 151.0]
+        nearest = self.__getValues(resource, lats, lons, InterpolationMethod.Nearest)
+        bilinear = self.__getValues(resource, lats, lons, InterpolationMethod.Bilinear)
+        inverse = self.__getValues(resource, lats, lons, InterpolationMethod.InverseDistance)
+
+        assert bilinear == pytest.approx(nearest)
+        assert inverse == pytest.approx(nearest)
+
+    def test_bilinear_between_points(self, resource):
+        from gribtoarrow import InterpolationMethod
+
+        # The grid is 0.5 degrees so 51.5, 0.25 is halfway between two points on the same row
+        west, east = self.__getValues(resource, [51.5, 51.5], [0.0, 0.5], InterpolationMethod.Nearest)
+        [middle] = self.__getValues(resource, [51.5], [0.25], InterpolationMethod.Bilinear)
+
+        assert middle == pytest.approx((west + east) / 2)
+
+    def test_inverse_distance_within_neighbours(self, resource):
+        from gribtoarrow import InterpolationMethod
+
+        corners = self.__getValues(resource, [51.5, 51.5, 52.0, 52.0], [0.0, 0.5, 0.0, 0.5], InterpolationMethod.Nearest)
+        [value] = self.__getValues(resource, [51.7], [0.2], InterpolationMethod.InverseDistance)
+
+        assert min(corners) <= value <= max(corners)
+
+    def test_every_message_interpolated(self, resource):
+        from gribtoarrow import GribReader, InterpolationMethod
+
+        reader = (
+            GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+            .withLocations(pl.DataFrame({"lat": [51.7, 53.4808], "lon": [0.2, 2.2426]}).to_arrow())
+            .withInterpolation(InterpolationMethod.Bilinear)
+        )
+        df = pl.concat(pl.from_arrow(message.getDataWithLocations()) for message in reader)
+
+        assert len(df) == 170
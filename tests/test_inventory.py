@@ -0,0 +1,35 @@
+import pyarrow as pa
+
+class TestInventory:
+
+    def test_default_keys(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+        inventory = reader.inventory()
+
+        assert inventory.num_rows == 85
+        assert inventory.column_names == ["shortName", "paramId", "step", "level", "number", "date", "gridType", "offset", "length"]
+        assert inventory.column("paramId")[0].as_py() == 156
+        assert inventory.column("offset")[0].as_py() == 0
+        assert inventory.schema.field("shortName").type == pa.string()
+        assert inventory.schema.field("step").type == pa.int64()
+
+    def test_matches_messages(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/meps_weatherapi_sorlandet.grb")
+        inventory = reader.inventory(["messageId", "shortName", "paramId"])
+
+        expected = [(message.getShortName(), message.getParameterId()) for message in reader]
+        actual = list(zip(inventory.column("shortName").to_pylist(), inventory.column("paramId").to_pylist()))
+
+        assert inventory.column("messageId").to_pylist() == list(range(268))
+        assert actual == expected
+
+    def test_missing_key_is_null(self, resource):
+        from gribtoarrow import GribReader
+
+        inventory = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").inventory(["paramId", "notAGribKey"])
+
+        assert inventory.column("notAGribKey").null_count == 85
@@ -0,0 +1,26 @@
+import pyarrow as pa
+
+class TestKeys:
+
+    def test_typed_keys(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+        batch = reader[0].getKeys(["shortName", "paramId", "level", "notAGribKey"])
+
+        assert batch.num_rows == 1
+        assert batch.schema.field("shortName").type == pa.string()
+        assert batch.schema.field("paramId").type == pa.int64()
+        assert batch.column(1)[0].as_py() == 156
+        assert batch.column(3).null_count == 1
+
+    def test_matches_single_key_getters(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/meps_weatherapi_sorlandet.grb")
+        for message in reader:
+            keys = message.getKeys(["shortName", "paramId"]).to_pylist()[0]
+            assert keys["shortName"] == message.getShortName()
+            assert keys["paramId"] == message.getParameterId()
+            assert message.tryGetKey("shortName") == message.getShortName()
+            assert message.tryGetKey("notAGribKey") is None
@@ -0,0 +1,31 @@
+import polars as pl
+import random
+
+class TestLocationIndex:
+
+    def __getLocations(self):
+        random.seed(42)
+        return pl.DataFrame(
+            {"lat": [random.uniform(55, 65) for _ in range(5000)],
+             "lon": [random.uniform(3, 11) for _ in range(5000)]}
+        )
+
+    def test_locations_match_grid_area(self, resource):
+        from gribtoarrow import GribReader
+
+        locations = self.__getLocations()
+        reader = GribReader(str(resource) + "/norway.grb").withLocations(locations.to_arrow())
+
+        for message in reader[0:2]:
+            lat1, lat2 = message.getLatitudeOfFirstPoint(), message.getLatitudeOfLastPoint()
+            lon1, lon2 = message.getLongitudeOfFirstPoint(), message.getLongitudeOfLastPoint()
+
+            expected = (
+                locations.with_row_index("surrogate_key")
+                .filter(pl.col("lat").is_between(min(lat1, lat2), max(lat1, lat2)))
+                .filter(pl.col("lon").is_between(min(lon1, lon2), max(lon1, lon2)))
+            )
+            df = pl.from_arrow(message.getDataWithLocations())
+
+            assert len(df) == len(expected)
+            assert df["surrogate_key"].cast(pl.UInt32).to_list() == expected["surrogate_key"].cast(pl.UInt32).to_list()
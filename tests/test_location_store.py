@@ -0,0 +1,70 @@
+import os
+import polars as pl
+
+class TestLocationStore:
+
+    def __getLocations(self):
+        return pl.DataFrame(
+            {"lat": [51.5054, 53.4808, -33.8688], "lon": [-0.027176, 2.2426, 151.2093]}
+        ).to_arrow()
+
+    def __getData(self, resource, store, locations=None):
+        from gribtoarrow import GribReader
+
+        reader = (
+            GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+            .withLocations(locations if locations is not None else self.__getLocations())
+            .withLocationStore(str(store))
+        )
+        return pl.concat(pl.from_arrow(message.getDataWithLocations()) for message in reader[0:3])
+
+    def test_store_is_reused(self, resource, tmp_path):
+        store = tmp_path / "locations"
+
+        first = self.__getData(resource, store)
+        files = os.listdir(store)
+        assert len(files) == 1
+
+        second = self.__getData(resource, store)
+        assert os.listdir(store) == files
+        assert first.equals(second)
+
+    def test_different_locations_are_stored_separately(self, resource, tmp_path):
+        store = tmp_path / "locations"
+
+        self.__getData(resource, store)
+        other = pl.DataFrame({"lat": [10.0], "lon": [20.0]}).to_arrow()
+        df = self.__getData(resource, store, other)
+
+        assert len(os.listdir(store)) == 2
+        assert len(df) == 3
+
+    def test_matches_without_store(self, resource, tmp_path):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withLocations(self.__getLocations())
+        expected = pl.concat(pl.from_arrow(message.getDataWithLocations()) for message in reader[0:3])
+
+        store = tmp_path / "locations"
+        self.__getData(resource, store)
+
+        assert expected.equals(self.__getData(resource, store))
+
+    def test_index_outside_grid_is_ignored(self, resource, tmp_path):
+        import pyarrow as pa
+        import pyarrow.ipc as ipc
+
+        store = tmp_path / "locations"
+        expected = self.__getData(resource, store)
+
+        #Point the stored locations past the end of the grid
+        path = store / os.listdir(store)[0]
+        with ipc.open_file(str(path)) as f:
+            batch = f.get_batch(0)
+            schema = f.schema
+        indexes = pa.array([2**31 - 1] * batch.num_rows, pa.int32())
+        batch = pa.record_batch([indexes] + batch.columns[1:], schema=schema)
+        with ipc.new_file(str(path), schema) as writer:
+            writer.write_batch(batch)
+
+        assert expected.equals(self.__getData(resource, store))
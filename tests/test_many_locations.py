@@ -0,0 +1,42 @@
+import polars as pl
+import random
+
+class TestManyLocations:
+
+    def __getLocations(self, count):
+        random.seed(7)
+        return pl.DataFrame(
+            {"lat": [random.uniform(-89, 89) for _ in range(count)],
+             "lon": [random.uniform(0, 359) for _ in range(count)]}
+        )
+
+    def test_surrogate_key_beyond_uint16(self, resource):
+        from gribtoarrow import GribReader
+
+        locations = self.__getLocations(70000)
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withLocations(locations.to_arrow())
+        df = pl.from_arrow(reader[0].getDataWithLocations())
+
+        assert df["surrogate_key"].dtype == pl.UInt32
+        assert len(df) == 70000
+        assert df["surrogate_key"].n_unique() == 70000
+        assert df["surrogate_key"].max() == 69999
+
+    def test_chunked_locations(self, resource):
+        from gribtoarrow import GribReader
+        import pyarrow as pa
+
+        locations = self.__getLocations(1000)
+        # Split the locations into several chunks
+        chunked = pa.concat_tables([locations[i:i + 100].to_arrow() for i in range(0, 1000, 100)])
+        assert chunked["lat"].num_chunks == 10
+
+        expected = pl.from_arrow(
+            GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withLocations(locations.to_arrow())[0].getDataWithLocations()
+        )
+        df = pl.from_arrow(
+            GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withLocations(chunked)[0].getDataWithLocations()
+        )
+
+        assert expected.equals(df)
+        assert df["lat"].to_list() == locations["lat"].to_list()
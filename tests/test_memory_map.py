@@ -0,0 +1,31 @@
+import polars as pl
+import pytest
+from polars.testing import assert_frame_equal
+
+class TestMemoryMap:
+
+    def test_iterate_memory_mapped(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/meps_weatherapi_sorlandet.grb").withMemoryMappedInput(True)
+
+        assert sum(1 for _ in reader) == 268
+
+    def test_same_results_as_file_input(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+        expected = pl.concat(pl.from_arrow(message.getData()) for message in reader)
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withMemoryMappedInput(True).withThreads(2)
+        df = pl.concat(pl.from_arrow(message.getData()) for message in reader)
+
+        assert_frame_equal(expected, df)
+
+    def test_compressed_file(self, resource):
+        import gribtoarrow
+
+        reader = gribtoarrow.GribReader(str(resource) + "/meps_weatherapi_sorlandet.grb.bz2").withMemoryMappedInput(True)
+
+        with pytest.raises(gribtoarrow.GribException):
+            iter(reader)
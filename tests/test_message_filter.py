@@ -0,0 +1,62 @@
+class TestMessageFilter:
+
+    def get_expected_ids(self, resource, predicate):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+        return [message.getGribMessageId() for message in reader if predicate(message)]
+
+    def test_filter_on_numeric_key(self, resource):
+        from gribtoarrow import GribReader
+
+        expected = self.get_expected_ids(resource, lambda m: m.getParameterId() in (156, 167))
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withFilter("paramId", [156, 167])
+
+        assert [message.getGribMessageId() for message in reader] == expected
+
+    def test_filter_on_string_key(self, resource):
+        from gribtoarrow import GribReader
+
+        expected = self.get_expected_ids(resource, lambda m: m.getShortName() == "gh")
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withFilter("shortName", ["gh"])
+        ids = [message.getGribMessageId() for message in reader]
+
+        assert 0 in ids
+        assert ids == expected
+
+    def test_combined_filters_with_threads(self, resource):
+        from gribtoarrow import GribReader
+
+        expected = self.get_expected_ids(resource, lambda m: m.getShortName() == "gh" and 0 <= m.getStep() <= 6)
+
+        reader = (
+            GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+                .withFilter("shortName", ["gh"])
+                .withRangeFilter("step", 0, 6)
+                .withThreads(2)
+        )
+
+        assert [message.getGribMessageId() for message in reader] == expected
+
+    def test_nothing_matches(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withFilter("paramId", [-1])
+
+        assert sum(1 for _ in reader) == 0
+
+    def test_same_messages_with_and_without_index(self, resource, tmp_path):
+        from gribtoarrow import GribReader
+
+        # The deterministic meps messages don't have an ensemble number so they must not match number 0 either way
+        for name in ["gep01.t00z.pgrb2a.0p50.f003", "meps_weatherapi_sorlandet.grb"]:
+            path = str(resource) + "/" + name
+            expected = [message.getGribMessageId() for message in GribReader(path).withFilter("number", [0])]
+
+            # The workers check the filter against the index rather than the message
+            index_path = str(tmp_path / (name + ".arrowidx"))
+            reader = GribReader(path).withIndex(index_path).withFilter("number", [0]).withThreads(2)
+
+            assert [message.getGribMessageId() for message in reader] == expected
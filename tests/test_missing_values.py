@@ -0,0 +1,33 @@
+import pyarrow.compute as pc
+
+class TestMissingValues:
+
+    def test_masked_points_are_null(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/norkyst800m_weatherapi_west_norway.grb")
+        message = reader[0]
+        values = message.getData(["Values"]).column("Values")
+
+        #The land points of the ocean model are missing
+        assert values.null_count > 0
+        assert values.null_count < len(values)
+        assert pc.sum(pc.equal(values, 9999)).as_py() in (0, None)
+
+    def test_float32_keeps_nulls(self, resource):
+        import pyarrow as pa
+        from gribtoarrow import GribReader
+
+        expected = GribReader(str(resource) + "/norkyst800m_weatherapi_west_norway.grb")[0].getData(["Values"])
+
+        reader = GribReader(str(resource) + "/norkyst800m_weatherapi_west_norway.grb").withValueType(pa.float32())
+        table = reader[0].getData(["Values"])
+
+        assert table.column("Values").null_count == expected.column("Values").null_count
+
+    def test_no_bitmap_has_no_nulls(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+
+        assert reader[0].getData().column("Values").null_count == 0
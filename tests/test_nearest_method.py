@@ -0,0 +1,43 @@
+import polars as pl
+from polars.testing import assert_frame_equal
+
+class TestNearestMethod:
+
+    def __getLocations(self):
+        return pl.DataFrame(
+            {"lat": [51.5054, 53.4808, -33.8688, 64.1466, 0.1],
+             "lon": [-0.027176, 2.2426, 151.2093, -21.9426, 179.9]}
+        ).to_arrow()
+
+    def __getNearest(self, resource, method):
+        from gribtoarrow import GribReader
+
+        reader = (
+            GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+            .withLocations(self.__getLocations())
+            .withNearestMethod(method)
+        )
+        return pl.from_arrow(reader[0].getDataWithLocations())
+
+    def test_kdtree_matches_eccodes(self, resource):
+        from gribtoarrow import NearestMethod
+
+        eccodes = self.__getNearest(resource, NearestMethod.Eccodes)
+        kdtree = self.__getNearest(resource, NearestMethod.KdTree)
+
+        columns = ["surrogate_key", "nearestlatitude", "nearestlongitude", "value"]
+        assert_frame_equal(eccodes.select(columns), kdtree.select(columns))
+        assert_frame_equal(eccodes.select("distance"), kdtree.select("distance"), atol=0.01)
+
+    def test_kdtree_all_messages(self, resource):
+        from gribtoarrow import GribReader, NearestMethod
+
+        reader = (
+            GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+            .withLocations(self.__getLocations())
+            .withNearestMethod(NearestMethod.KdTree)
+        )
+        df = pl.concat(pl.from_arrow(message.getDataWithLocations()) for message in reader)
+
+        # 85 messages with 5 locations each
+        assert len(df) == 425
@@ -0,0 +1,51 @@
+import polars as pl
+from polars.testing import assert_frame_equal
+
+class TestProjection:
+
+    def __getLocations(self):
+        return pl.DataFrame(
+            {"lat": [51.5054, 53.4808, -33.8688, 64.1466, 0.1],
+             "lon": [-0.027176, 2.2426, 151.2093, -21.9426, 179.9]}
+        ).to_arrow()
+
+    def __getData(self, resource, path, locations, method, interpolation=None):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + path).withLocations(locations).withNearestMethod(method)
+        if interpolation is not None:
+            reader = reader.withInterpolation(interpolation)
+        return pl.concat(pl.from_arrow(message.getDataWithLocations()) for message in reader[0:2])
+
+    def test_projection_matches_eccodes_on_global_grid(self, resource):
+        from gribtoarrow import NearestMethod
+
+        path = "/gep01.t00z.pgrb2a.0p50.f003"
+        eccodes = self.__getData(resource, path, self.__getLocations(), NearestMethod.Eccodes)
+        projection = self.__getData(resource, path, self.__getLocations(), NearestMethod.Projection)
+
+        columns = ["surrogate_key", "nearestlatitude", "nearestlongitude", "value"]
+        assert_frame_equal(eccodes.select(columns), projection.select(columns))
+        assert_frame_equal(eccodes.select("distance"), projection.select("distance"), atol=0.01)
+
+    def test_projection_matches_eccodes_on_regional_grids(self, resource):
+        from gribtoarrow import NearestMethod
+
+        # kristiansand and Bergen are on different grids of the file
+        locations = pl.DataFrame(
+            {"location_id": [1, 2], "lat": [58.1599, 60.3913], "lon": [8.0182, 5.3221]}
+        ).to_arrow()
+        eccodes = self.__getData(resource, "/norway.grb", locations, NearestMethod.Eccodes)
+        projection = self.__getData(resource, "/norway.grb", locations, NearestMethod.Projection)
+
+        columns = ["location_id", "nearestlatitude", "nearestlongitude", "value"]
+        assert_frame_equal(eccodes.select(columns), projection.select(columns))
+
+    def test_bilinear_matches_eccodes_cells(self, resource):
+        from gribtoarrow import InterpolationMethod, NearestMethod
+
+        path = "/gep01.t00z.pgrb2a.0p50.f003"
+        eccodes = self.__getData(resource, path, self.__getLocations(), NearestMethod.Eccodes, InterpolationMethod.Bilinear)
+        projection = self.__getData(resource, path, self.__getLocations(), NearestMethod.Projection, InterpolationMethod.Bilinear)
+
+        assert_frame_equal(eccodes.select("value"), projection.select("value"), rtol=1e-6)
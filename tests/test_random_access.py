@@ -0,0 +1,46 @@
+import os
+import polars as pl
+import pytest
+
+class TestRandomAccess:
+
+    def test_get_message_by_id(self, resource, tmp_path):
+        from gribtoarrow import GribReader
+
+        index_path = str(tmp_path / "gep01.arrowidx")
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withIndex(index_path)
+
+        assert os.path.exists(index_path)
+        assert len(reader) == 85
+
+        message = reader[0]
+        assert message.getGribMessageId() == 0
+        assert message.getShortName() == "gh"
+        assert len(pl.from_arrow(message.getData())) == 259920
+
+        assert reader[-1].getGribMessageId() == 84
+
+        with pytest.raises(IndexError):
+            reader[85]
+
+    def test_slice(self, resource, tmp_path):
+        from gribtoarrow import GribReader
+
+        index_path = str(tmp_path / "meps.arrowidx")
+        reader = GribReader(str(resource) + "/meps_weatherapi_sorlandet.grb").withIndex(index_path)
+
+        assert [m.getGribMessageId() for m in reader[10:20:2]] == [10, 12, 14, 16, 18]
+
+    def test_index_is_reused(self, resource, tmp_path):
+        from gribtoarrow import GribReader
+
+        index_path = str(tmp_path / "meps.arrowidx")
+        GribReader(str(resource) + "/meps_weatherapi_sorlandet.grb").withIndex(index_path)
+        modified = os.path.getmtime(index_path)
+
+        reader = GribReader(str(resource) + "/meps_weatherapi_sorlandet.grb").withIndex(index_path)
+
+        assert os.path.getmtime(index_path) == modified
+        index = pl.from_arrow(reader.getIndex())
+        assert len(index) == 268
+        assert index["messageId"].to_list() == list(range(268))
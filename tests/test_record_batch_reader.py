@@ -0,0 +1,66 @@
+import polars as pl
+import pyarrow as pa
+
+class TestRecordBatchReader:
+
+    def __getLocations(self):
+        # Locations are Canary Wharf and Manchester
+        return pl.DataFrame(
+            {"lat": [51.5054, 53.4808], "lon": [-0.027176, 2.2426]}
+        ).to_arrow()
+
+    def test_stream_with_locations(self, resource):
+        from gribtoarrow import GribReader
+
+        locations = self.__getLocations()
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withLocations(locations)
+        expected = pl.concat(pl.from_arrow(message.getDataWithLocations()) for message in reader)
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withLocations(locations)
+        batch_reader = reader.toRecordBatchReader()
+
+        assert isinstance(batch_reader, pa.RecordBatchReader)
+        df = pl.from_arrow(batch_reader.read_all())
+
+        assert len(df) == 170
+        assert df.columns == expected.columns
+        assert df["value"].to_list() == expected["value"].to_list()
+
+    def test_stream_without_locations(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withFilter("paramId", [156])
+
+        # Import via the arrow PyCapsule interface rather than toRecordBatchReader
+        table = pa.RecordBatchReader._import_from_c_capsule(reader.__arrow_c_stream__()).read_all()
+
+        assert "Values" in table.column_names
+        assert "parameterId" in table.column_names
+        assert set(table["parameterId"].to_pylist()) == {156}
+        assert len(table) % 259920 == 0
+
+    def test_stream_twice_then_iterate(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withLocations(self.__getLocations())
+
+        # Each stream reads the messages at their offsets so the reader keeps its own position
+        first = pl.from_arrow(reader.toRecordBatchReader().read_all())
+        second = pl.from_arrow(reader.toRecordBatchReader().read_all())
+        iterated = pl.concat(pl.from_arrow(message.getDataWithLocations()) for message in reader)
+
+        assert len(first) == 170
+        assert first.equals(second)
+        assert first["value"].to_list() == iterated["value"].to_list()
+
+    def test_stream_after_iterating(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withFilter("paramId", [156])
+        ids = [message.getGribMessageId() for message in reader]
+
+        table = reader.toRecordBatchReader().read_all()
+
+        assert len(ids) > 0
+        assert len(table.to_batches()) == len(ids)
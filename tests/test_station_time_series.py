@@ -0,0 +1,68 @@
+import polars as pl
+import pytest
+
+class TestStationTimeSeries:
+
+    def __getLocations(self):
+        return pl.DataFrame(
+            {"name": ["London", "Amsterdam", "Sydney"], "lat": [51.5054, 52.3676, -33.8688], "lon": [-0.027176, 4.9041, 151.2093]}
+        ).to_arrow()
+
+    def __getReader(self, resource):
+        from gribtoarrow import GribReader
+
+        return (
+            GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+            .withLocations(self.__getLocations())
+            .withFilter("paramId", [167])
+        )
+
+    def test_matches_pivoted_values(self, resource):
+        wide = pl.from_arrow(self.__getReader(resource).toStationTimeSeries())
+        long = pl.concat(
+            pl.from_arrow(message.getDataWithLocations()) for message in self.__getReader(resource)
+        )
+
+        assert wide.shape[0] == 3
+        assert wide["name"].to_list() == ["London", "Amsterdam", "Sydney"]
+
+        value_columns = [column for column in wide.columns if column.startswith("167_")]
+        assert len(value_columns) == long.select(["parameterId", "datetime"]).unique().shape[0]
+        for (datetime,), values in long.sort("surrogate_key").group_by(["datetime"]):
+            column = "167_" + datetime.strftime("%Y-%m-%dT%H:%M:%S")
+            assert wide[column].to_list() == values["value"].to_list()
+
+    def test_field_metadata(self, resource):
+        table = self.__getReader(resource).toStationTimeSeries()
+
+        field = table.schema.field(table.num_columns - 1)
+        assert field.metadata[b"parameterId"] == b"167"
+        assert field.name == "167_" + field.metadata[b"datetime"].decode()
+
+    def test_duplicate_keys_raise(self, resource):
+        from gribtoarrow import GribReader, GribException
+
+        reader = (
+            GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+            .withLocations(self.__getLocations())
+            .withFilter("shortName", ["gh"])
+        )
+        with pytest.raises(GribException):
+            reader.toStationTimeSeries()
+
+    def test_requires_locations(self, resource):
+        from gribtoarrow import GribReader, InvalidSchemaException
+
+        with pytest.raises(InvalidSchemaException):
+            GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").toStationTimeSeries()
+
+    def test_called_twice_then_iterated(self, resource):
+        reader = self.__getReader(resource)
+
+        first = pl.from_arrow(reader.toStationTimeSeries())
+        second = pl.from_arrow(reader.toStationTimeSeries())
+        messages = [message.getParameterId() for message in reader]
+
+        assert first.equals(second)
+        assert len(messages) > 0
+        assert set(messages) == {167}
@@ -0,0 +1,51 @@
+import polars as pl
+from polars.testing import assert_frame_equal
+
+class TestThreads:
+
+    def __getLocations(self):
+        # Locations are Canary Wharf and Manchester
+        return pl.DataFrame(
+            {"lat": [51.5054, 53.4808], "lon": [-0.027176, 2.2426]}
+        ).to_arrow()
+
+    def test_messages_are_returned_in_order(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/meps_weatherapi_sorlandet.grb").withThreads(4)
+
+        message_ids = [message.getGribMessageId() for message in reader]
+
+        assert message_ids == list(range(268))
+
+    def test_same_results_as_single_thread(self, resource):
+        from gribtoarrow import GribReader
+
+        locations = self.__getLocations()
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withLocations(locations)
+        expected = pl.concat(pl.from_arrow(message.getDataWithLocations()) for message in reader)
+
+        reader = (
+            GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+                .withLocations(locations)
+                .withThreads(4, maxBufferedMessages=2)
+        )
+        df = pl.concat(pl.from_arrow(message.getDataWithLocations()) for message in reader)
+
+        assert_frame_equal(expected, df)
+
+    def test_each_grid_is_searched_once(self, resource):
+        from gribtoarrow import GribReader
+
+        # norway.grb combines two grids, the workers wait for a grid being searched by another worker
+        locations = pl.DataFrame({"lat": [58.1599, 60.3913], "lon": [8.0182, 5.3221]}).to_arrow()
+
+        reader = GribReader(str(resource) + "/norway.grb").withLocations(locations)
+        expected = pl.concat(pl.from_arrow(message.getDataWithLocations()) for message in reader)
+
+        reader = GribReader(str(resource) + "/norway.grb").withLocations(locations).withThreads(4)
+        df = pl.concat(pl.from_arrow(message.getDataWithLocations()) for message in reader)
+
+        assert_frame_equal(expected, df)
+        assert reader.getCacheStats()["locations"].entries == 2
@@ -0,0 +1,53 @@
+import polars as pl
+import pytest
+
+class TestValueExtraction:
+
+    def __getLocations(self):
+        return pl.DataFrame(
+            {"lat": [51.5054, 53.4808, -33.8688], "lon": [-0.027176, 2.2426, 151.2093]}
+        ).to_arrow()
+
+    def __getReader(self, resource, extraction):
+        from gribtoarrow import GribReader
+
+        return (
+            GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+            .withLocations(self.__getLocations())
+            .withValueExtraction(extraction)
+        )
+
+    def test_both_paths_return_same_values(self, resource):
+        from gribtoarrow import ValueExtraction
+
+        elements = pl.concat(
+            pl.from_arrow(message.getDataWithLocations()) for message in self.__getReader(resource, ValueExtraction.Elements)
+        )
+        decoded = pl.concat(
+            pl.from_arrow(message.getDataWithLocations()) for message in self.__getReader(resource, ValueExtraction.FullDecode)
+        )
+
+        assert elements.equals(decoded)
+
+    def test_stats_record_path(self, resource):
+        from gribtoarrow import ValueExtraction
+
+        message = self.__getReader(resource, ValueExtraction.FullDecode)[0]
+        assert message.getExtractionStats() is None
+
+        message.getDataWithLocations()
+        stats = message.getExtractionStats()
+
+        assert stats.method == ValueExtraction.FullDecode
+        assert stats.requestedValues == 3
+        assert stats.numberOfPoints == 259920
+        assert stats.packingType != ""
+        assert stats.milliseconds >= 0
+
+    def test_auto_chooses_a_path(self, resource):
+        from gribtoarrow import ValueExtraction
+
+        message = self.__getReader(resource, ValueExtraction.Auto)[0]
+        message.getDataWithLocations()
+
+        assert message.getExtractionStats().method in (ValueExtraction.Elements, ValueExtraction.FullDecode)
@@ -0,0 +1,51 @@
+import pyarrow as pa
+import polars as pl
+import pytest
+
+class TestValueType:
+
+    def test_default_is_float64(self, resource):
+        from gribtoarrow import GribReader
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+        table = reader[0].getData()
+
+        assert table.schema.field("Values").type == pa.float64()
+
+    def test_float32_values(self, resource):
+        from gribtoarrow import GribReader
+
+        expected = pl.from_arrow(GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")[0].getData())
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withValueType(pa.float32())
+        #The second message uses the cached coordinates
+        tables = [message.getData() for message in reader[0:2]]
+
+        for table in tables:
+            assert table.schema.field("Latitudes").type == pa.float32()
+            assert table.schema.field("Longitudes").type == pa.float32()
+            assert table.schema.field("Values").type == pa.float32()
+
+        df = pl.from_arrow(tables[0])
+        assert (df["Values"].cast(pl.Float64) - expected["Values"]).abs().max() < 1e-3
+        assert (df["Latitudes"].cast(pl.Float64) - expected["Latitudes"]).abs().max() < 1e-4
+
+    def test_float32_with_locations(self, resource):
+        from gribtoarrow import GribReader
+
+        locations = pa.Table.from_pydict({"name": ["London", "Oslo"], "lat": [51.5, 59.9], "lon": [-0.1, 10.7]})
+
+        reader = (GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+                    .withLocations(locations)
+                    .withValueType(pa.float32()))
+        table = reader[0].getDataWithLocations()
+
+        for name in ["distance", "nearestlatitude", "nearestlongitude", "value"]:
+            assert table.schema.field(name).type == pa.float32()
+        assert table.num_rows == 2
+
+    def test_invalid_value_type(self, resource):
+        import gribtoarrow
+
+        with pytest.raises(gribtoarrow.InvalidSchemaException):
+            gribtoarrow.GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003").withValueType(pa.int32())
@@ -95,3 +95,12 @@ class TestLocations:
         assert all('Boddingtons' == field for field in manc['beer'])
         assert all('oasis' == field for field in manc['band'])
 
+
+    def test_requires_locations(self, resource):
+        import pytest
+        from gribtoarrow import GribReader, InvalidSchemaException
+
+        reader = GribReader(str(resource) + "/gep01.t00z.pgrb2a.0p50.f003")
+
+        with pytest.raises(InvalidSchemaException):
+            reader[0].getDataWithLocations()